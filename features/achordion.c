@@ -22,46 +22,535 @@
 
 #include "achordion.h"
 
+#ifdef ACHORDION_STREAK
+#include "keycode_classes.h"
+#endif  // ACHORDION_STREAK
+
+#ifdef ACHORDION_DATA
+#include "achordion_data.h"
+#endif  // ACHORDION_DATA
+#if defined(ACHORDION_STREAK) && defined(ACHORDION_STREAK_BIGRAMS)
+#include "achordion_streak_data.h"
+#endif  // defined(ACHORDION_STREAK) && defined(ACHORDION_STREAK_BIGRAMS)
+#ifdef ACHORDION_CLASSIFIER
+#include "achordion_classifier.h"
+#if ACHORDION_CLASSIFIER_NUM_FEATURES != 6
+#error "achordion: achordion_classifier.h is out of date. Please regenerate it."
+#endif
+#endif  // ACHORDION_CLASSIFIER
+
 #if !defined(IS_QK_MOD_TAP)
 // Attempt to detect out-of-date QMK installation, which would fail with
 // implicit-function-declaration errors in the code below.
 #error "achordion: QMK version is too old to build. Please update QMK."
 #else
 
-// Copy of the `record` and `keycode` args for the current active tap-hold key.
-static keyrecord_t tap_hold_record;
-static uint16_t tap_hold_keycode = KC_NO;
-// Timeout timer. When it expires, the key is considered held.
-static uint16_t hold_timer = 0;
-// Eagerly applied mods, if any.
-static uint8_t eager_mods = 0;
-// Flag to determine whether another key is pressed within the timeout.
-static bool pressed_another_key_before_release = false;
+// A tap-hold key tracked by Achordion.
+typedef struct {
+  // Copy of the `record` and `keycode` args for the tap-hold key.
+  keyrecord_t record;
+  uint16_t keycode;
+  // Timeout timer. When it expires, the key is considered held.
+  uint16_t hold_timer;
+  // Eagerly applied mods, if any.
+  uint8_t eager_mods;
+  // Whether the layer of a layer-tap key is eagerly activated.
+  bool eager_layer;
+  // Settling state of this key, one of the STATE_* values below.
+  uint8_t state;
+  // Flag to determine whether another key is pressed within the timeout.
+  bool pressed_another_key_before_release;
+#ifdef ACHORDION_SPECULATIVE
+  // Whether the tap was sent speculatively on press, and not yet settled.
+  bool speculated;
+#endif  // ACHORDION_SPECULATIVE
+#ifdef ACHORDION_CLASSIFIER
+  // Position of the key pressed before this one, and whether it is still held.
+  keypos_t prev_pos;
+  bool prev_down;
+  // Time in ms from the previous key's press to this key's press.
+  uint8_t idle;
+  // Time in ms that the previous key was held after this key's press.
+  uint8_t overlap;
+#endif  // ACHORDION_CLASSIFIER
+} tap_hold_t;
+
+// Queue of active tap-hold keys, in the order they were pressed. A key stays in
+// the queue from its press until its release. Keys are settled strictly in
+// order, so the unsettled keys always form a suffix of the queue.
+static tap_hold_t queue[ACHORDION_QUEUE_SIZE];
+static uint8_t queue_size = 0;
+
+// Flag set while calling `process_record()`, which will recursively call
+// `process_achordion()`. This is checked so that we don't process events
+// generated by Achordion and potentially create an infinite loop.
+static bool recursing = false;
 
 #ifdef ACHORDION_STREAK
 // Timer for typing streak
 static uint16_t streak_timer = 0;
-#else
-// When disabled, is_streak is never true
-#define is_streak false
 #endif
 
-// Achordion's current state.
+#if TAP_CODE_DELAY > 0
+// Rather than blocking with wait_ms() between the tap press and release, the
+// release is scheduled and plumbed by `achordion_task()` once TAP_CODE_DELAY
+// has elapsed, or before the next press is plumbed if that is sooner. So at
+// most one release is pending.
+static keyrecord_t pending_release;
+// Time at which the pending release is plumbed.
+static uint16_t pending_release_time = 0;
+static bool release_pending = false;
+#endif  // TAP_CODE_DELAY > 0
+
+// Settling state of a tap-hold key.
 enum {
-  // A tap-hold key is pressed, but hasn't yet been settled as tapped or held.
+  // The key is pressed, but hasn't yet been settled as tapped or held.
   STATE_UNSETTLED,
-  // Achordion is inactive.
-  STATE_RELEASED,
-  // Active tap-hold key has been settled as tapped.
+  // The key has been settled as tapped.
   STATE_TAPPING,
-  // Active tap-hold key has been settled as held.
+  // The key has been settled as held.
   STATE_HOLDING,
-  // This state is set while calling `process_record()`, which will recursively
-  // call `process_achordion()`. This state is checked so that we don't process
-  // events generated by Achordion and potentially create an infinite loop.
-  STATE_RECURSING,
 };
-static uint8_t achordion_state = STATE_RELEASED;
+
+// Timeout in ms of the default `achordion_timeout()`.
+#define DEFAULT_TIMEOUT 1000
+
+#ifdef ACHORDION_DATA
+// Values marking unspecified entries in the generated tables.
+#define DATA_UNSET_BYTE 0xff
+#define DATA_UNSET_WORD 0xffff
+
+// Returns the index of `pos` in the generated tables, or -1 if out of range.
+static int16_t data_index(keypos_t pos) {
+  return (pos.row < ACHORDION_DATA_ROWS && pos.col < ACHORDION_DATA_COLS)
+             ? pos.row * ACHORDION_DATA_COLS + pos.col
+             : -1;
+}
+
+static uint16_t read_data_word(const uint16_t* table, keypos_t pos) {
+  const int16_t i = data_index(pos);
+  return i >= 0 ? pgm_read_word(table + i) : DATA_UNSET_WORD;
+}
+
+static uint8_t read_data_byte(const uint8_t* table, keypos_t pos) {
+  const int16_t i = data_index(pos);
+  return i >= 0 ? pgm_read_byte(table + i) : DATA_UNSET_BYTE;
+}
+
+uint16_t achordion_data_tapping_term(keypos_t pos) {
+  const uint16_t value = read_data_word(achordion_tapping_term_data, pos);
+  return value != DATA_UNSET_WORD ? value : TAPPING_TERM;
+}
+
+uint16_t achordion_data_quick_tap_term(keypos_t pos) {
+  const uint8_t value = read_data_byte(achordion_quick_tap_term_data, pos);
+  return value != DATA_UNSET_BYTE ? value : QUICK_TAP_TERM;
+}
+
+bool achordion_data_retro_tapping(keypos_t pos) {
+  const int16_t i = data_index(pos);
+  // Bit 0 is the retro tapping setting, bit 1 whether it is specified.
+  return i >= 0 && (pgm_read_byte(achordion_flags_data + i) & 1) != 0;
+}
+#endif  // ACHORDION_DATA
+
+#ifdef ACHORDION_ADAPTIVE
+// Learned typing rhythm for a tap-hold key. This is what is saved to EEPROM.
+typedef struct {
+  keypos_t pos;
+  // Number of samples, saturating at 255.
+  uint8_t num_samples;
+  // Running averages in units of 1/16 ms of how long the key is held when
+  // tapped and of the gap from its press to the next key press.
+  uint16_t tap_duration;
+  uint16_t gap;
+} adaptive_key_t;
+
+// Block of learned values in EEPROM. The EEPROM area holds several of these
+// slots, written in rotation for wear leveling.
+typedef struct {
+  uint8_t magic;
+  // Sequence number, incremented on every write. The slot with the latest
+  // sequence number is the current one.
+  uint8_t seq;
+  adaptive_key_t keys[ACHORDION_ADAPTIVE_KEYS];
+  // Running average over all keys of the gap between key presses.
+  uint16_t gap;
+} adaptive_block_t;
+
+#define ADAPTIVE_MAGIC 0xac
+// Weight of a new sample in the running averages is 1 / 2^ADAPTIVE_SHIFT.
+#define ADAPTIVE_SHIFT 3
+// Samples needed before learned values are used.
+#define ADAPTIVE_MIN_SAMPLES 16
+// Longest duration sampled, in ms.
+#define ADAPTIVE_MAX_SAMPLE 4000
+
+_Static_assert(ACHORDION_ADAPTIVE_EEPROM_SLOTS * sizeof(adaptive_block_t) <=
+                   ACHORDION_ADAPTIVE_EEPROM_SIZE,
+               "achordion: ACHORDION_ADAPTIVE_EEPROM_SIZE is too small.");
+#ifdef ACHORDION_ADAPTIVE_EEPROM_OFFSET
+_Static_assert(ACHORDION_ADAPTIVE_EEPROM_OFFSET >= 0,
+               "achordion: ACHORDION_ADAPTIVE needs a larger "
+               "EECONFIG_USER_DATA_SIZE, or define "
+               "ACHORDION_ADAPTIVE_EEPROM_ADDR.");
+#endif  // ACHORDION_ADAPTIVE_EEPROM_OFFSET
+
+static adaptive_block_t adaptive = {0};
+// Index of the EEPROM slot that was last read or written.
+static uint8_t adaptive_slot = 0;
+static bool adaptive_loaded = false;
+static bool adaptive_dirty = false;
+static uint32_t adaptive_save_timer = 0;
+
+// Per-key state for taking samples, not saved.
+static struct {
+  uint16_t press_time;
+  // Gap to the next key press, held until the key is known to be tapped.
+  uint16_t pending_gap;
+  bool tapped;
+} adaptive_samples[ACHORDION_ADAPTIVE_KEYS];
+// Index of the last pressed tap-hold key that is waiting for a gap sample, or
+// ACHORDION_ADAPTIVE_KEYS if none.
+static uint8_t adaptive_gap_key = ACHORDION_ADAPTIVE_KEYS;
+static uint16_t adaptive_last_press_time = 0;
+
+static adaptive_block_t* adaptive_eeprom_slot(uint8_t slot) {
+  return (adaptive_block_t*)(ACHORDION_ADAPTIVE_EEPROM_ADDR) + slot;
+}
+
+// Loads the latest slot of learned values from EEPROM.
+static void adaptive_load(void) {
+  adaptive_block_t block;
+  bool found = false;
+  for (uint8_t slot = 0; slot < ACHORDION_ADAPTIVE_EEPROM_SLOTS; ++slot) {
+    eeprom_read_block(&block, adaptive_eeprom_slot(slot), sizeof(block));
+    if (block.magic == ADAPTIVE_MAGIC &&
+        (!found || (int8_t)(block.seq - adaptive.seq) > 0)) {
+      adaptive = block;
+      adaptive_slot = slot;
+      found = true;
+    }
+  }
+  if (!found) {
+    memset(&adaptive, 0, sizeof(adaptive));
+    adaptive.magic = ADAPTIVE_MAGIC;
+    // Mark all entries as unused.
+    for (uint8_t i = 0; i < ACHORDION_ADAPTIVE_KEYS; ++i) {
+      adaptive.keys[i].pos.row = 255;
+    }
+  }
+  adaptive_loaded = true;
+  dprintf("Achordion: Loaded adaptive timeouts from slot %u.\n", adaptive_slot);
+}
+
+// Saves learned values to the next EEPROM slot.
+static void adaptive_save(void) {
+  adaptive_slot = (adaptive_slot + 1) % ACHORDION_ADAPTIVE_EEPROM_SLOTS;
+  ++adaptive.seq;
+  eeprom_update_block(&adaptive, adaptive_eeprom_slot(adaptive_slot),
+                      sizeof(adaptive));
+  adaptive_dirty = false;
+  dprintf("Achordion: Saved adaptive timeouts to slot %u.\n", adaptive_slot);
+}
+
+// Updates the running average `avg` with a new sample in ms.
+static void adaptive_update(uint16_t* avg, uint16_t sample) {
+  if (sample > ADAPTIVE_MAX_SAMPLE) {
+    sample = ADAPTIVE_MAX_SAMPLE;
+  }
+  *avg += ((int32_t)sample * 16 - *avg) / (1 << ADAPTIVE_SHIFT);
+  adaptive_dirty = true;
+}
+
+// Finds the entry for `pos`, or if `create` is true and there is none, reuses
+// an unused entry or else the one with the fewest samples. Returns
+// ACHORDION_ADAPTIVE_KEYS if none.
+static uint8_t adaptive_find(keypos_t pos, bool create) {
+  uint8_t reuse = ACHORDION_ADAPTIVE_KEYS;
+  for (uint8_t i = 0; i < ACHORDION_ADAPTIVE_KEYS; ++i) {
+    const adaptive_key_t* key = &adaptive.keys[i];
+    if (KEYEQ(key->pos, pos)) {
+      return i;
+    } else if (i != adaptive_gap_key &&
+               (reuse == ACHORDION_ADAPTIVE_KEYS || key->pos.row == 255 ||
+                (adaptive.keys[reuse].pos.row != 255 &&
+                 key->num_samples < adaptive.keys[reuse].num_samples))) {
+      reuse = i;
+    }
+  }
+  if (create && reuse < ACHORDION_ADAPTIVE_KEYS) {
+    memset(&adaptive.keys[reuse], 0, sizeof(adaptive_key_t));
+    adaptive.keys[reuse].pos = pos;
+    return reuse;
+  }
+  return ACHORDION_ADAPTIVE_KEYS;
+}
+
+// Records a gap sample for entry `i` if it is known to be tapped.
+static void adaptive_commit_gap(uint8_t i) {
+  if (adaptive_samples[i].tapped && adaptive_samples[i].pending_gap) {
+    adaptive_update(&adaptive.keys[i].gap, adaptive_samples[i].pending_gap);
+    if (adaptive.keys[i].num_samples < 255) {
+      ++adaptive.keys[i].num_samples;
+    }
+    adaptive_samples[i].pending_gap = 0;
+  }
+}
+
+// Samples the gaps between key presses.
+static void adaptive_on_press(uint16_t keycode, keyrecord_t* record) {
+  const uint16_t time = record->event.time;
+  if (adaptive_last_press_time) {
+    adaptive_update(&adaptive.gap,
+                    TIMER_DIFF_16(time, adaptive_last_press_time));
+  }
+  adaptive_last_press_time = time | 1;
+
+  if (adaptive_gap_key < ACHORDION_ADAPTIVE_KEYS &&
+      !KEYEQ(adaptive.keys[adaptive_gap_key].pos, record->event.key)) {
+    // This is the next key press after a tap-hold key.
+    adaptive_samples[adaptive_gap_key].pending_gap =
+        TIMER_DIFF_16(time, adaptive_samples[adaptive_gap_key].press_time) | 1;
+    adaptive_commit_gap(adaptive_gap_key);
+    adaptive_gap_key = ACHORDION_ADAPTIVE_KEYS;
+  }
+
+  if ((IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode)) &&
+      IS_KEYEVENT(record->event)) {
+    const uint8_t i = adaptive_find(record->event.key, true);
+    if (i < ACHORDION_ADAPTIVE_KEYS) {
+      adaptive_samples[i].press_time = time;
+      adaptive_samples[i].pending_gap = 0;
+      adaptive_samples[i].tapped = record->tap.count > 0;
+      adaptive_gap_key = i;
+    }
+  }
+}
+
+// Called when the tap-hold key at `pos` is settled as tapped.
+static void adaptive_on_tap(keypos_t pos) {
+  const uint8_t i = adaptive_find(pos, false);
+  if (i < ACHORDION_ADAPTIVE_KEYS) {
+    adaptive_samples[i].tapped = true;
+    adaptive_commit_gap(i);
+  }
+}
+
+// Called when the tap-hold key at `pos` is released after being tapped.
+static void adaptive_on_tap_release(keypos_t pos, uint16_t time) {
+  const uint8_t i = adaptive_find(pos, false);
+  if (i < ACHORDION_ADAPTIVE_KEYS && adaptive_samples[i].tapped) {
+    adaptive_update(&adaptive.keys[i].tap_duration,
+                    TIMER_DIFF_16(time, adaptive_samples[i].press_time));
+  }
+}
+
+// Adjusts the configured `timeout` for the key at `pos` to the learned rhythm.
+// The timeout is twice the longer of how long the key is held when tapped and
+// the gap to the next key, constrained between the minimum and `timeout`.
+static uint16_t adaptive_timeout(keypos_t pos, uint16_t timeout) {
+  const uint8_t i = adaptive_find(pos, false);
+  if (i < ACHORDION_ADAPTIVE_KEYS &&
+      adaptive.keys[i].num_samples >= ADAPTIVE_MIN_SAMPLES) {
+    const adaptive_key_t* key = &adaptive.keys[i];
+    uint16_t learned = (key->tap_duration > key->gap ? key->tap_duration
+                                                     : key->gap) / 8;
+    if (learned < ACHORDION_ADAPTIVE_MIN_TIMEOUT) {
+      learned = ACHORDION_ADAPTIVE_MIN_TIMEOUT;
+    }
+    if (learned < timeout) {
+      return learned;
+    }
+  }
+  return timeout;
+}
+
+static void adaptive_task(void) {
+  if (!adaptive_loaded) {
+    adaptive_load();
+    adaptive_save_timer = timer_read32();
+  } else if (adaptive_dirty && timer_elapsed32(adaptive_save_timer) >=
+                                   ACHORDION_ADAPTIVE_SAVE_INTERVAL) {
+    // Rate limit writes to reduce EEPROM wear.
+    adaptive_save();
+    adaptive_save_timer = timer_read32();
+  }
+}
+#endif  // ACHORDION_ADAPTIVE
+
+#ifdef ACHORDION_TELEMETRY
+static achordion_telemetry_t telemetry = {0};
+
+// Records that `key` was settled with `outcome`.
+static void record_telemetry(const tap_hold_t* key, uint8_t outcome) {
+  // Bucket 0 is under 16 ms, then each bucket is twice as long as the last.
+  uint16_t t = TIMER_DIFF_16(timer_read(), key->record.event.time) >> 4;
+  uint8_t bucket = 0;
+  for (; t && bucket < ACHORDION_TELEMETRY_BUCKETS - 1; t >>= 1) {
+    ++bucket;
+  }
+
+  ++telemetry.count[outcome];
+  if (telemetry.histogram[outcome][bucket] < UINT16_MAX) {
+    ++telemetry.histogram[outcome][bucket];
+  }
+}
+
+const achordion_telemetry_t* achordion_telemetry(void) { return &telemetry; }
+
+void achordion_telemetry_reset(void) {
+  memset(&telemetry, 0, sizeof(telemetry));
+}
+
+void achordion_telemetry_print(void) {
+#ifndef NO_PRINT
+  static const char* const outcome_names[] = {"hold", "tap", "timeout",
+                                              "streak", "queue full"};
+  uprintln("Achordion telemetry (ms: <16 <32 <64 <128 <256 <512 <1024 more):");
+  for (uint8_t i = 0; i < ACHORDION_NUM_OUTCOMES; ++i) {
+    uprintf("%10s %6lu:", outcome_names[i], (unsigned long)telemetry.count[i]);
+    for (uint8_t b = 0; b < ACHORDION_TELEMETRY_BUCKETS; ++b) {
+      uprintf(" %u", telemetry.histogram[i][b]);
+    }
+    uprintln("");
+  }
+#endif  // NO_PRINT
+}
+
+void achordion_telemetry_raw_hid(uint8_t* data, uint8_t length) {
+  const uint8_t page = data[1];
+  memset(data + 2, 0, length - 2);
+
+  if (page == 0) {
+    for (uint8_t i = 0; i < ACHORDION_NUM_OUTCOMES && 4 * i + 6 <= length;
+         ++i) {
+      const uint32_t count = telemetry.count[i];
+      data[4 * i + 2] = (uint8_t)count;
+      data[4 * i + 3] = (uint8_t)(count >> 8);
+      data[4 * i + 4] = (uint8_t)(count >> 16);
+      data[4 * i + 5] = (uint8_t)(count >> 24);
+    }
+  } else if (page <= ACHORDION_NUM_OUTCOMES) {
+    const uint16_t* histogram = telemetry.histogram[page - 1];
+    for (uint8_t b = 0; b < ACHORDION_TELEMETRY_BUCKETS && 2 * b + 4 <= length;
+         ++b) {
+      data[2 * b + 2] = (uint8_t)histogram[b];
+      data[2 * b + 3] = (uint8_t)(histogram[b] >> 8);
+    }
+  } else if (page == 255) {
+    achordion_telemetry_reset();
+  }
+}
+#else
+// When disabled, telemetry compiles to nothing.
+#define record_telemetry(key, outcome)
+#endif  // ACHORDION_TELEMETRY
+
+#ifdef ACHORDION_CLASSIFIER
+// A key press, tracked for the classifier's rhythm features.
+typedef struct {
+  keypos_t pos;
+  uint16_t time;
+  // Whether the key is still held.
+  bool down;
+  bool valid;
+} press_info_t;
+
+// The most recent key press and the one before it.
+static press_info_t last_press = {0};
+static press_info_t prev_press = {0};
+
+static uint8_t saturate_ms(uint16_t ms) { return ms < 255 ? ms : 255; }
+
+// Updates the tracked key presses and overlap times on the event `record`.
+static void classifier_on_event(const keyrecord_t* record) {
+  const keypos_t pos = record->event.key;
+  if (record->event.pressed) {
+    prev_press = last_press;
+    last_press.pos = pos;
+    last_press.time = record->event.time;
+    last_press.down = true;
+    last_press.valid = true;
+    return;
+  }
+
+  if (KEYEQ(last_press.pos, pos)) {
+    last_press.down = false;
+  }
+  for (uint8_t i = 0; i < queue_size; ++i) {
+    tap_hold_t* key = &queue[i];
+    if (key->prev_down && KEYEQ(key->prev_pos, pos)) {
+      key->prev_down = false;
+      key->overlap = saturate_ms(
+          TIMER_DIFF_16(record->event.time, key->record.event.time));
+    }
+  }
+}
+
+// Sets the rhythm features of the newly pressed `key`.
+static void classifier_on_enqueue(tap_hold_t* key) {
+  key->prev_pos = prev_press.pos;
+  key->prev_down = prev_press.valid && prev_press.down;
+  key->idle = prev_press.valid ? saturate_ms(TIMER_DIFF_16(
+                                     key->record.event.time, prev_press.time))
+                               : 255;
+  key->overlap = 0;
+}
+
+// Evaluates the linear classifier from achordion_classifier.h, returning true
+// if `key` and the other key form a chord. The features are, in order: the
+// time between the two presses, the idle time before `key` was pressed, the
+// time the previous key overlapped with `key`, whether the keys are on
+// opposite hands, whether they are on the same row, and whether the other key
+// is a tap-hold key. Times are in ms, saturated to 255. The trainer
+// make_achordion_classifier.py computes the same features from logs, where the
+// tap-hold keys are the positions whose presses are marked.
+static bool classify_chord(const tap_hold_t* key, uint16_t other_keycode,
+                           const keyrecord_t* other_record) {
+  const uint8_t gap = saturate_ms(
+      TIMER_DIFF_16(other_record->event.time, key->record.event.time));
+  const uint8_t features[ACHORDION_CLASSIFIER_NUM_FEATURES] = {
+      gap,
+      key->idle,
+      key->prev_down ? gap : key->overlap,
+      achordion_opposite_hands(&key->record, other_record),
+      key->record.event.key.row == other_record->event.key.row,
+      IS_QK_MOD_TAP(other_keycode) || IS_QK_LAYER_TAP(other_keycode),
+  };
+
+  int32_t score = ACHORDION_CLASSIFIER_BIAS;
+  for (uint8_t i = 0; i < ACHORDION_CLASSIFIER_NUM_FEATURES; ++i) {
+    score += (int32_t)(int16_t)pgm_read_word(achordion_classifier_weights + i) *
+             features[i];
+  }
+  return score > 0;
+}
+#endif  // ACHORDION_CLASSIFIER
+
+// Gets the timeout for the tap-hold key `keycode` pressed in `record`.
+static uint16_t get_timeout(uint16_t keycode, const keyrecord_t* record) {
+  uint16_t timeout = achordion_timeout(keycode);
+#ifdef ACHORDION_DATA
+  if (timeout == ACHORDION_USE_DATA) {
+    timeout = read_data_word(achordion_timeout_data, record->event.key);
+    if (timeout == DATA_UNSET_WORD) {
+      timeout = DEFAULT_TIMEOUT;
+    }
+  }
+#endif  // ACHORDION_DATA
+#ifdef ACHORDION_ADAPTIVE
+  return adaptive_timeout(record->event.key, timeout);
+#else
+  return timeout;
+#endif  // ACHORDION_ADAPTIVE
+}
+
+// Returns true if `key` should be settled as held when the other key
+// `keycode` is pressed in `record`.
+static bool is_chord(tap_hold_t* key, uint16_t keycode, keyrecord_t* record) {
+  return achordion_chord(key->keycode, &key->record, keycode, record);
+}
 
 #ifdef ACHORDION_STREAK
 static void update_streak_timer(uint16_t keycode, keyrecord_t* record) {
@@ -72,21 +561,115 @@ static void update_streak_timer(uint16_t keycode, keyrecord_t* record) {
     streak_timer = 0;
   }
 }
+
+// Returns true if pressing `next_keycode` continues a typing streak, in which
+// case `key` should be settled as tapped.
+static bool is_streak(const tap_hold_t* key, uint16_t next_keycode,
+                      const keyrecord_t* next_record) {
+  uint16_t s_timeout =
+      achordion_streak_chord_timeout(key->keycode, next_keycode);
+#ifdef ACHORDION_DATA
+  if (s_timeout == ACHORDION_USE_DATA) {
+    const uint8_t limit =
+        read_data_byte(achordion_streak_timeout_data, key->record.event.key);
+#ifdef ACHORDION_STREAK_BIGRAMS
+    // The policy's streak timeout for the key bounds the bigram timeout.
+    s_timeout = achordion_streak_bigram_timeout(key->keycode, next_keycode);
+    if (limit != DATA_UNSET_BYTE && limit < s_timeout) {
+      s_timeout = limit;
+    }
+#else
+    s_timeout = (limit != DATA_UNSET_BYTE)
+                    ? limit
+                    : achordion_streak_timeout(key->keycode);
+#endif  // ACHORDION_STREAK_BIGRAMS
+  }
+#endif  // ACHORDION_DATA
+  return streak_timer && s_timeout &&
+         !timer_expired(next_record->event.time, (streak_timer + s_timeout));
+}
+#else
+// When disabled, is_streak is never true
+#define is_streak(key, next_keycode, next_record) false
 #endif
 
-// Presses or releases eager_mods through process_action(), which skips the
-// usual event handling pipeline. The action is considered as a mod-tap hold or
-// release, with Retro Tapping if enabled.
-static void process_eager_mods_action(void) {
+// Returns the index of the first unsettled key, or `queue_size` if none.
+static uint8_t first_unsettled(void) {
+  uint8_t i = 0;
+  while (i < queue_size && queue[i].state != STATE_UNSETTLED) {
+    ++i;
+  }
+  return i;
+}
+
+// Presses or releases eager_mods or the eager layer through process_action(),
+// which skips the usual event handling pipeline. The action is considered as a
+// mod-tap or layer-tap hold or release, with Retro Tapping if enabled.
+static void process_eager_action(tap_hold_t* key) {
   action_t action;
-  action.code = ACTION_MODS_TAP_KEY(
-      eager_mods, QK_MOD_TAP_GET_TAP_KEYCODE(tap_hold_keycode));
-  process_action(&tap_hold_record, action);
+  if (key->eager_layer) {
+    action.code =
+        ACTION_LAYER_TAP_KEY(QK_LAYER_TAP_GET_LAYER(key->keycode),
+                             QK_LAYER_TAP_GET_TAP_KEYCODE(key->keycode));
+  } else {
+    action.code = ACTION_MODS_TAP_KEY(
+        key->eager_mods, QK_MOD_TAP_GET_TAP_KEYCODE(key->keycode));
+  }
+  process_action(&key->record, action);
+}
+
+#ifdef ACHORDION_STREAK
+// Returns the keycode of the event `record` as looked up with the eager layers
+// of the unsettled keys off, that is, as if those layer-tap keys were tapped.
+static uint16_t keycode_without_eager_layers(uint16_t keycode,
+                                             const keyrecord_t* record) {
+  layer_state_t state = layer_state;
+  for (uint8_t i = first_unsettled(); i < queue_size; ++i) {
+    if (queue[i].eager_layer) {
+      state &= ~((layer_state_t)1 << QK_LAYER_TAP_GET_LAYER(queue[i].keycode));
+    }
+  }
+  if (state == layer_state || !IS_KEYEVENT(record->event)) {
+    return keycode;
+  }
+
+  // Set layer_state directly to look up the key without calling the layer
+  // state callbacks.
+  const layer_state_t saved_state = layer_state;
+  layer_state = state;
+  keycode = keymap_key_to_keycode(layer_switch_get_layer(record->event.key),
+                                  record->event.key);
+  layer_state = saved_state;
+  return keycode;
 }
+#endif  // ACHORDION_STREAK
 
-// Calls `process_record()` with state set to RECURSING.
-static void recursively_process_record(keyrecord_t* record, uint8_t state) {
-  achordion_state = STATE_RECURSING;
+#if TAP_CODE_DELAY > 0
+// Takes the pending tap release, returning its record, or NULL if there is
+// none. The debug message reports the time since the tap press was plumbed,
+// the latency documented with TAP_CODE_DELAY in achordion.h.
+static keyrecord_t* take_pending_release(void) {
+  if (!release_pending) {
+    return NULL;
+  }
+  dprintf("Achordion: Plumbing tap release, %u ms after press.\n",
+          TIMER_DIFF_16(timer_read(), pending_release_time - TAP_CODE_DELAY));
+  release_pending = false;
+  return &pending_release;
+}
+#endif  // TAP_CODE_DELAY > 0
+
+// Calls `process_record()` with the recursion flag set. With TAP_CODE_DELAY,
+// the pending tap release is plumbed before a press, so that the host gets
+// each tap's release before any key pressed after it.
+static void recursively_process_record(keyrecord_t* record) {
+#if TAP_CODE_DELAY > 0
+  keyrecord_t* release;
+  if (record->event.pressed && (release = take_pending_release())) {
+    recursively_process_record(release);
+  }
+#endif  // TAP_CODE_DELAY > 0
+  recursing = true;
 #if defined(POINTING_DEVICE_ENABLE) && defined(POINTING_DEVICE_AUTO_MOUSE_ENABLE)
   int8_t mouse_key_tracker = get_auto_mouse_key_tracker();
 #endif
@@ -94,86 +677,381 @@ static void recursively_process_record(keyrecord_t* record, uint8_t state) {
 #if defined(POINTING_DEVICE_ENABLE) && defined(POINTING_DEVICE_AUTO_MOUSE_ENABLE)
   set_auto_mouse_key_tracker(mouse_key_tracker);
 #endif
-  achordion_state = state;
+  recursing = false;
 }
 
-// Sends hold press event and settles the active tap-hold key as held.
-static void settle_as_hold(void) {
-  if (eager_mods) {
-    // If eager mods are being applied, nothing needs to be done besides
-    // updating the state.
-    dprintln("Achordion: Settled eager mod as hold.");
-    achordion_state = STATE_HOLDING;
+#if TAP_CODE_DELAY > 0
+// Plumbs the pending tap release now, if any.
+static void plumb_pending_release(void) {
+  keyrecord_t* release = take_pending_release();
+  if (release) {
+    recursively_process_record(release);
+  }
+}
+#endif  // TAP_CODE_DELAY > 0
+
+// Plumbs the release of a tap whose press `record` was just plumbed. With
+// TAP_CODE_DELAY, the release is scheduled rather than plumbed now. On return,
+// `record` is revised as the release event.
+static void plumb_tap_release(keyrecord_t* record) {
+  send_keyboard_report();
+  record->event.pressed = false;
+
+#if TAP_CODE_DELAY > 0
+  // Schedule the tap release event. Any earlier pending release was plumbed
+  // before the press.
+  pending_release = *record;
+  pending_release_time = timer_read() + TAP_CODE_DELAY;
+  release_pending = true;
+#else
+  dprintln("Achordion: Plumbing tap release.");
+  // Plumb tap release event.
+  recursively_process_record(record);
+#endif  // TAP_CODE_DELAY > 0
+}
+
+// Plumbs a tap press and release for the tap-hold key event `record`. On
+// return, `record` is revised as the release event.
+static void plumb_tap(keyrecord_t* record) {
+  dprintln("Achordion: Plumbing tap press.");
+  record->event.pressed = true;
+  record->tap.count = 1;  // Revise event as a tap.
+  record->tap.interrupted = true;
+  // Plumb tap press event.
+  recursively_process_record(record);
+  plumb_tap_release(record);
+}
+
+#ifdef ACHORDION_SPECULATIVE
+#ifdef REPEAT_KEY_ENABLE
+// Repeat Key state from before the speculative tap, restored on retraction.
+static uint16_t speculative_last_keycode = KC_NO;
+static uint8_t speculative_last_mods = 0;
+#endif  // REPEAT_KEY_ENABLE
+
+// Sends the tap of `key` speculatively, before it is settled.
+static void speculate_tap(tap_hold_t* key) {
+  dprintln("Achordion: Speculatively plumbing tap.");
+#ifdef REPEAT_KEY_ENABLE
+  speculative_last_keycode = get_last_keycode();
+  speculative_last_mods = get_last_mods();
+#endif  // REPEAT_KEY_ENABLE
+  keyrecord_t record = key->record;
+  plumb_tap(&record);
+  key->speculated = true;
+}
+
+// Undoes the speculative tap of `key` with a backspace, since the key is
+// being settled as held. Shift is cleared while the backspace is sent, since
+// Shift + Backspace may do something else. Where records carry a keycode, the
+// backspace is plumbed like the tap, so that features tracking the typed text,
+// like Autocorrection and Sentence Case, see the tap undone.
+static void retract_speculative_tap(tap_hold_t* key) {
+  dprintln("Achordion: Retracting speculative tap.");
+#if TAP_CODE_DELAY > 0
+  // The backspace is a later press, so the pending release goes first.
+  plumb_pending_release();
+#endif  // TAP_CODE_DELAY > 0
+  const uint8_t saved_mods = get_mods();
+  const uint8_t saved_weak_mods = get_weak_mods();
+  del_mods(MOD_MASK_SHIFT);
+  del_weak_mods(MOD_MASK_SHIFT);
+#if defined(COMBO_ENABLE) || defined(REPEAT_KEY_ENABLE)
+  keyrecord_t record = key->record;
+  record.keycode = KC_BSPC;
+  record.tap.count = 0;
+  record.event.pressed = true;
+  recursively_process_record(&record);
+  plumb_tap_release(&record);
+#else
+  tap_code(KC_BSPC);
+#endif  // defined(COMBO_ENABLE) || defined(REPEAT_KEY_ENABLE)
+  set_mods(saved_mods);
+  set_weak_mods(saved_weak_mods);
+  send_keyboard_report();
+#ifdef REPEAT_KEY_ENABLE
+  // Forget the retracted tap as the key to repeat.
+  set_last_keycode(speculative_last_keycode);
+  set_last_mods(speculative_last_mods);
+#endif  // REPEAT_KEY_ENABLE
+  key->speculated = false;
+}
+#endif  // ACHORDION_SPECULATIVE
+
+// Sends hold press event and settles `key` as held.
+static void settle_as_hold(tap_hold_t* key) {
+  key->state = STATE_HOLDING;
+#ifdef ACHORDION_SPECULATIVE
+  if (key->speculated) {
+    retract_speculative_tap(key);
+  }
+#endif  // ACHORDION_SPECULATIVE
+  if (key->eager_mods || key->eager_layer) {
+    // If eager mods or layer are being applied, nothing needs to be done
+    // besides updating the state.
+    dprintln("Achordion: Settled eager mod or layer as hold.");
   } else {
     // Create hold press event.
     dprintln("Achordion: Plumbing hold press.");
-    recursively_process_record(&tap_hold_record, STATE_HOLDING);
+    recursively_process_record(&key->record);
   }
 }
 
-// Sends tap press and release and settles the active tap-hold key as tapped.
-static void settle_as_tap(void) {
-  if (eager_mods) {  // Clear eager mods if set.
+// Sends tap press and release and settles `key` as tapped.
+static void settle_as_tap(tap_hold_t* key) {
+  key->state = STATE_TAPPING;
+#ifdef ACHORDION_ADAPTIVE
+  adaptive_on_tap(key->record.event.key);
+#endif  // ACHORDION_ADAPTIVE
+#ifdef ACHORDION_SPECULATIVE
+  if (key->speculated) {
+    // The tap was already sent, so it only needs to be confirmed.
+    dprintln("Achordion: Confirmed speculative tap.");
+    key->speculated = false;
+    key->record.event.pressed = false;
+    return;
+  }
+#endif  // ACHORDION_SPECULATIVE
+  if (key->eager_mods) {  // Clear eager mods if set.
 #if defined(RETRO_TAPPING) || defined(RETRO_TAPPING_PER_KEY)
 #ifdef DUMMY_MOD_NEUTRALIZER_KEYCODE
     neutralize_flashing_modifiers(get_mods());
 #endif  // DUMMY_MOD_NEUTRALIZER_KEYCODE
 #endif  // defined(RETRO_TAPPING) || defined(RETRO_TAPPING_PER_KEY)
-    tap_hold_record.event.pressed = false;
+    key->record.event.pressed = false;
     // To avoid falsely triggering Retro Tapping, process eager mods release as
     // a regular mods release rather than a mod-tap release.
     action_t action;
-    action.code = ACTION_MODS(eager_mods);
-    process_action(&tap_hold_record, action);
-    eager_mods = 0;
+    action.code = ACTION_MODS(key->eager_mods);
+    process_action(&key->record, action);
+    key->eager_mods = 0;
+  } else if (key->eager_layer) {  // Roll back the eager layer if set.
+    // As with eager mods, the layer is turned off directly rather than by a
+    // layer-tap release to avoid falsely triggering Retro Tapping.
+    layer_off(QK_LAYER_TAP_GET_LAYER(key->keycode));
+    key->eager_layer = false;
   }
 
-  dprintln("Achordion: Plumbing tap press.");
-  tap_hold_record.event.pressed = true;
-  tap_hold_record.tap.count = 1;  // Revise event as a tap.
-  tap_hold_record.tap.interrupted = true;
-  // Plumb tap press event.
-  recursively_process_record(&tap_hold_record, STATE_TAPPING);
+  plumb_tap(&key->record);
+}
 
-  send_keyboard_report();
-#if TAP_CODE_DELAY > 0
-  wait_ms(TAP_CODE_DELAY);
-#endif  // TAP_CODE_DELAY > 0
+// Settles the unsettled keys before index `end`, in order. Each is settled as
+// held if it forms a chord with the other key, `keycode` and `record`, and
+// otherwise as tapped. Returns true if the active layers may have changed, that
+// is, if any layer-tap key was settled as held or its eager layer rolled back.
+static bool settle_keys_against(uint8_t end, uint16_t keycode,
+                                keyrecord_t* record) {
+  // Check that this is a normal key event, don't act on combos.
+  const bool is_key_event = IS_KEYEVENT(record->event);
+  bool layers_changed = false;
+#ifdef ACHORDION_STREAK
+  // With an eager layer on, `keycode` is on that layer. A typing streak is
+  // checked with the keycode on the layers below, as if the layer-tap key were
+  // tapped.
+  const uint16_t tap_keycode = keycode_without_eager_layers(keycode, record);
+  bool tapped = false;
+#endif
 
-  dprintln("Achordion: Plumbing tap release.");
-  tap_hold_record.event.pressed = false;
-  // Plumb tap release event.
-  recursively_process_record(&tap_hold_record, STATE_TAPPING);
+  for (uint8_t i = first_unsettled(); i < end; ++i) {
+    tap_hold_t* key = &queue[i];
+    // We implement the tap or hold by plumbing events back into the handling
+    // pipeline so that QMK features and other user code can see them. This is
+    // done by calling `process_record()`, which in turn calls most handlers
+    // including `process_record_user()`.
+    const bool streak = is_streak(key, tap_keycode, record);
+    if (!streak && (!is_key_event || is_chord(key, keycode, record))) {
+      record_telemetry(key, ACHORDION_OUTCOME_HOLD);
+      settle_as_hold(key);
+      layers_changed |= IS_QK_LAYER_TAP(key->keycode);
+    } else {
+      record_telemetry(
+          key, streak ? ACHORDION_OUTCOME_STREAK : ACHORDION_OUTCOME_TAP);
+      layers_changed |= key->eager_layer;
+      settle_as_tap(key);
+#ifdef ACHORDION_STREAK
+      tapped = true;
+#endif
+    }
+  }
+
+#ifdef ACHORDION_STREAK
+  // The streak timer is updated once all keys are settled, so that each is
+  // checked against the keys before it rather than a tap settled by this same
+  // event.
+  if (tapped) {
+    update_streak_timer(tap_keycode, record);
+  }
+#endif
+  return layers_changed;
+}
+
+// Handles release of the key at index `i` in the queue by the release event
+// `record`, and removes it.
+static void release_key(uint8_t i, const keyrecord_t* record) {
+  tap_hold_t* key = &queue[i];
+
+  if (key->state == STATE_UNSETTLED) {
+    if (first_unsettled() < i) {
+      // Released while earlier keys are still unsettled, e.g. in a roll where
+      // this key was pressed and released within another tap-hold key. This
+      // key is the "other" key deciding the earlier keys, and is itself
+      // settled as tapped.
+      settle_keys_against(i, key->keycode, &key->record);
+      record_telemetry(key, ACHORDION_OUTCOME_TAP);
+      settle_as_tap(key);
+    } else if (key->pressed_another_key_before_release) {
+      // Released before the keys pressed after it were settled, that is, the
+      // key was rolled. Settle it as tapped; later keys remain unsettled.
+      record_telemetry(key, ACHORDION_OUTCOME_TAP);
+      settle_as_tap(key);
+    } else {
+      record_telemetry(key, ACHORDION_OUTCOME_HOLD);
+    }
+  }
+
+#ifdef ACHORDION_ADAPTIVE
+  if (key->state == STATE_TAPPING) {
+    adaptive_on_tap_release(key->record.event.key, record->event.time);
+  }
+#endif  // ACHORDION_ADAPTIVE
+
+  if (key->eager_mods || key->eager_layer) {
+    dprintln("Achordion: Key released. Clearing eager mods or layer.");
+    key->record.event.pressed = false;
+    process_eager_action(key);
+  } else if (key->state == STATE_HOLDING) {
+    dprintln("Achordion: Key released. Plumbing hold release.");
+    key->record.event.pressed = false;
+    // Plumb hold release event.
+    recursively_process_record(&key->record);
+  } else if (key->state == STATE_UNSETTLED) {
+    // No other key was pressed between the press and release of the tap-hold
+    // key, plumb a hold press and then a release.
+#ifdef ACHORDION_SPECULATIVE
+    if (key->speculated) {
+      retract_speculative_tap(key);
+    }
+#endif  // ACHORDION_SPECULATIVE
+    dprintln("Achordion: Key released. Plumbing hold press and release.");
+    recursively_process_record(&key->record);
+    key->record.event.pressed = false;
+    recursively_process_record(&key->record);
+  } else {
+    dprintln("Achordion: Key released.");
+  }
+
+  // Remove the key from the queue.
+  --queue_size;
+  for (; i < queue_size; ++i) {
+    queue[i] = queue[i + 1];
+  }
 }
 
 bool process_achordion(uint16_t keycode, keyrecord_t* record) {
   // Don't process events that Achordion generated.
-  if (achordion_state == STATE_RECURSING) {
+  if (recursing) {
     return true;
   }
 
+#if TAP_CODE_DELAY > 0
+  if (record->event.pressed) {
+    // Plumb the pending tap release before this press, so that it is sent in
+    // order with it. If the key of the pending release is pressed again, this
+    // also keeps the new press from being lost.
+    plumb_pending_release();
+  }
+#endif  // TAP_CODE_DELAY > 0
+#ifdef ACHORDION_CLASSIFIER
+  if (IS_KEYEVENT(record->event)) {
+    classifier_on_event(record);
+  }
+#endif  // ACHORDION_CLASSIFIER
+
+  // Release of a tap-hold key in the queue.
+  if (!record->event.pressed) {
+    for (uint8_t i = 0; i < queue_size; ++i) {
+      if (queue[i].keycode == keycode) {
+        release_key(i, record);
+        return false;
+      }
+    }
+
+#ifdef ACHORDION_ADAPTIVE
+    if ((IS_QK_MOD_TAP(keycode) || IS_QK_LAYER_TAP(keycode)) &&
+        record->tap.count > 0) {
+      adaptive_on_tap_release(record->event.key, record->event.time);
+    }
+#endif  // ACHORDION_ADAPTIVE
+#ifdef ACHORDION_STREAK
+    // update idle timer on regular keys event
+    update_streak_timer(keycode, record);
+#endif
+    return true;
+  }
+
+#ifdef ACHORDION_ADAPTIVE
+  adaptive_on_press(keycode, record);
+#endif  // ACHORDION_ADAPTIVE
+
+  // Track whether another key was pressed while using the tap-hold keys.
+  for (uint8_t i = 0; i < queue_size; ++i) {
+    if (queue[i].keycode != keycode) {
+      queue[i].pressed_another_key_before_release = true;
+    }
+  }
+
   // Determine whether the current event is for a mod-tap or layer-tap key.
   const bool is_mt = IS_QK_MOD_TAP(keycode);
   const bool is_tap_hold = is_mt || IS_QK_LAYER_TAP(keycode);
   // Check that this is a normal key event, don't act on combos.
   const bool is_key_event = IS_KEYEVENT(record->event);
+  uint8_t first = first_unsettled();
+
+  if (is_tap_hold && record->tap.count == 0 && is_key_event) {
+    // A tap-hold key is pressed and considered by QMK as "held".
+    const uint16_t timeout = get_timeout(keycode, record);
+    // A key with timeout 0 is not queued. Its press falls through to settle
+    // the unsettled keys against it below, like a press of a regular key.
+    if (timeout > 0) {
+      // If typing in a streak, settle the unsettled keys as tapped.
+      while (first < queue_size && is_streak(&queue[first], keycode, record)) {
+#ifdef ACHORDION_STREAK
+        update_streak_timer(queue[first].keycode, &queue[first].record);
+#endif
+        record_telemetry(&queue[first], ACHORDION_OUTCOME_STREAK);
+        settle_as_tap(&queue[first++]);
+      }
+
+      if (queue_size < ACHORDION_QUEUE_SIZE) {
+        // Enqueue this key. It is settled after the keys pressed before it.
+        tap_hold_t* key = &queue[queue_size++];
+        key->keycode = keycode;
+        key->record = *record;
+        key->hold_timer = record->event.time + timeout;
+        key->eager_mods = 0;
+        key->eager_layer = false;
+        key->state = STATE_UNSETTLED;
+        key->pressed_another_key_before_release = false;
+#ifdef ACHORDION_CLASSIFIER
+        classifier_on_enqueue(key);
+#endif  // ACHORDION_CLASSIFIER
+#ifdef ACHORDION_SPECULATIVE
+        key->speculated = false;
 
-  // Event while no tap-hold key is active.
-  if (achordion_state == STATE_RELEASED) {
-    if (is_tap_hold && record->tap.count == 0 && record->event.pressed &&
-        is_key_event) {
-      // A tap-hold key is pressed and considered by QMK as "held".
-      const uint16_t timeout = achordion_timeout(keycode);
-      if (timeout > 0) {
-        achordion_state = STATE_UNSETTLED;
-        // Save info about this key.
-        tap_hold_keycode = keycode;
-        tap_hold_record = *record;
-        hold_timer = record->event.time + timeout;
-        pressed_another_key_before_release = false;
-        eager_mods = 0;
-
-        if (is_mt) {  // Apply mods immediately if they are "eager."
+        // Send the tap immediately if the key is eligible. As with eager mods,
+        // this is done only if no earlier key is unsettled, so that taps are
+        // sent in order. It is skipped while mods other than Shift are held,
+        // which would turn the tap into a hotkey.
+        if (first == queue_size - 1 &&
+            (get_mods() & ~MOD_MASK_SHIFT) == 0 &&
+            achordion_speculative_tap(keycode, record)) {
+          speculate_tap(key);
+        } else
+#endif  // ACHORDION_SPECULATIVE
+        // Apply mods immediately if they are "eager." This is done only if no
+        // earlier key is unsettled, since otherwise the mods would apply to
+        // the earlier key were it settled as tapped.
+        if (is_mt && first == queue_size - 1) {
           const uint8_t mod = mod_config(QK_MOD_TAP_GET_MODS(keycode));
           if (
 #if defined(CAPS_WORD_ENABLE) && defined(CAPS_WORD_INVERT_ON_SHIFT)
@@ -183,111 +1061,56 @@ bool process_achordion(uint16_t keycode, keyrecord_t* record) {
               !(is_caps_word_on() && (mod & MOD_LSFT) != 0) &&
 #endif  // defined(CAPS_WORD_ENABLE) && defined(CAPS_WORD_INVERT_ON_SHIFT)
               achordion_eager_mod(mod)) {
-            eager_mods = mod;
-            process_eager_mods_action();
+            key->eager_mods = mod;
+            process_eager_action(key);
           }
+        } else if (!is_mt && first == queue_size - 1 &&
+                   achordion_eager_layer(QK_LAYER_TAP_GET_LAYER(keycode))) {
+          // Likewise, activate the layer of a layer-tap key immediately if it
+          // is eager. It is rolled back if the key is settled as tapped.
+          key->eager_layer = true;
+          process_eager_action(key);
         }
 
         dprintf("Achordion: Key 0x%04X pressed.%s\n", keycode,
-                eager_mods ? " Set eager mods." : "");
+                key->eager_mods    ? " Set eager mods."
+                : key->eager_layer ? " Set eager layer."
+                                   : "");
         return false;  // Skip default handling.
       }
-    }
 
-#ifdef ACHORDION_STREAK
-    update_streak_timer(keycode, record);
-#endif
-    return true;  // Otherwise, continue with default handling.
-  } else if (record->event.pressed && tap_hold_keycode != keycode) {
-    // Track whether another key was pressed while using a tap-hold key.
-    pressed_another_key_before_release = true;
-  }
-
-  // Release of the active tap-hold key.
-  if (keycode == tap_hold_keycode && !record->event.pressed) {
-    if (eager_mods) {
-      dprintln("Achordion: Key released. Clearing eager mods.");
-      tap_hold_record.event.pressed = false;
-      process_eager_mods_action();
-    } else if (achordion_state == STATE_HOLDING) {
-      dprintln("Achordion: Key released. Plumbing hold release.");
-      tap_hold_record.event.pressed = false;
-      // Plumb hold release event.
-      recursively_process_record(&tap_hold_record, STATE_RELEASED);
-    } else if (!pressed_another_key_before_release) {
-      // No other key was pressed between the press and release of the tap-hold
-      // key, plumb a hold press and then a release.
-      dprintln("Achordion: Key released. Plumbing hold press and release.");
-      recursively_process_record(&tap_hold_record, STATE_HOLDING);
-      tap_hold_record.event.pressed = false;
-      recursively_process_record(&tap_hold_record, STATE_RELEASED);
-    } else {
-      dprintln("Achordion: Key released.");
+      // The queue is full. Settle the unsettled keys as held so that this key
+      // is handled as usual by QMK.
+      dprintln("Achordion: Queue is full.");
+      for (; first < queue_size; ++first) {
+        record_telemetry(&queue[first], ACHORDION_OUTCOME_QUEUE_FULL);
+        settle_as_hold(&queue[first]);
+      }
+      recursively_process_record(record);  // Re-process event.
+      return false;  // Block the original event.
     }
-
-    achordion_state = STATE_RELEASED;
-    tap_hold_keycode = KC_NO;
-    return false;
   }
 
-  if (achordion_state == STATE_UNSETTLED && record->event.pressed) {
-#ifdef ACHORDION_STREAK
-    const uint16_t s_timeout =
-        achordion_streak_chord_timeout(tap_hold_keycode, keycode);
-    const bool is_streak =
-        streak_timer && s_timeout &&
-        !timer_expired(record->event.time, (streak_timer + s_timeout));
-#endif
-
-    // Press event occurred on a key other than the active tap-hold key.
-
-    // If the other key is *also* a tap-hold key and considered by QMK to be
-    // held, then we settle the active key as held. This way, things like
-    // chording multiple home row modifiers will work, but let's our logic
-    // consider simply a single tap-hold key as "active" at a time.
-    //
-    // Otherwise, we call `achordion_chord()` to determine whether to settle the
-    // tap-hold key as tapped vs. held. We implement the tap or hold by plumbing
-    // events back into the handling pipeline so that QMK features and other
-    // user code can see them. This is done by calling `process_record()`, which
-    // in turn calls most handlers including `process_record_user()`.
-    if (!is_streak &&
-        (!is_key_event || (is_tap_hold && record->tap.count == 0) ||
-         achordion_chord(tap_hold_keycode, &tap_hold_record, keycode,
-                         record))) {
-      settle_as_hold();
-
+  if (first < queue_size) {
+    // Press event occurred on a key other than the unsettled tap-hold keys.
+    // Settle each of them according to `achordion_chord()`. This way, things
+    // like chording multiple home row modifiers will work. The event itself is
+    // not buffered, see ACHORDION_QUEUE_SIZE in achordion.h.
+    if (settle_keys_against(queue_size, keycode, record)) {
 #ifdef REPEAT_KEY_ENABLE
       // Edge case involving LT + Repeat Key: in a sequence of "LT down, other
       // down" where "other" is on the other layer in the same position as
       // Repeat or Alternate Repeat, the repeated keycode is set instead of the
-      // the one on the switched-to layer. Here we correct that.
-      if (get_repeat_key_count() != 0 && IS_QK_LAYER_TAP(tap_hold_keycode)) {
+      // the one on the switched-to layer. Likewise when an eager layer is
+      // rolled back. Here we correct that.
+      if (get_repeat_key_count() != 0) {
         record->keycode = KC_NO;  // Forget the repeated keycode.
         clear_weak_mods();
       }
 #endif  // REPEAT_KEY_ENABLE
-    } else {
-      settle_as_tap();
-
-#ifdef ACHORDION_STREAK
-      update_streak_timer(keycode, record);
-      if (is_streak && is_key_event && is_tap_hold && record->tap.count == 0) {
-        // If we are in a streak and resolved the current tap-hold key as a tap
-        // consider the next tap-hold key as active to be resolved next.
-        update_streak_timer(tap_hold_keycode, &tap_hold_record);
-        const uint16_t timeout = achordion_timeout(keycode);
-        tap_hold_keycode = keycode;
-        tap_hold_record = *record;
-        hold_timer = record->event.time + timeout;
-        achordion_state = STATE_UNSETTLED;
-        pressed_another_key_before_release = false;
-        return false;
-      }
-#endif
     }
 
-    recursively_process_record(record, achordion_state);  // Re-process event.
+    recursively_process_record(record);  // Re-process event.
     return false;  // Block the original event.
   }
 
@@ -299,18 +1122,43 @@ bool process_achordion(uint16_t keycode, keyrecord_t* record) {
 }
 
 void achordion_task(void) {
-  if (achordion_state == STATE_UNSETTLED &&
-      timer_expired(timer_read(), hold_timer)) {
-    settle_as_hold();  // Timeout expired, settle the key as held.
+#if TAP_CODE_DELAY > 0
+  // Plumb the scheduled tap release if it is due.
+  if (release_pending && timer_expired(timer_read(), pending_release_time)) {
+    plumb_pending_release();
+  }
+#endif  // TAP_CODE_DELAY > 0
+
+  // Settle unsettled keys whose timeout expired as held, in order.
+  for (uint8_t i = first_unsettled();
+       i < queue_size && timer_expired(timer_read(), queue[i].hold_timer);
+       ++i) {
+    record_telemetry(&queue[i], ACHORDION_OUTCOME_TIMEOUT);
+    settle_as_hold(&queue[i]);  // Timeout expired, settle the key as held.
   }
 
 #ifdef ACHORDION_STREAK
 #define MAX_STREAK_TIMEOUT 800
+#ifdef ACHORDION_ADAPTIVE
+  // End the streak after a pause of several times the average gap between
+  // key presses, but no longer than MAX_STREAK_TIMEOUT.
+  uint16_t streak_timeout = adaptive.gap / 4;
+  if (streak_timeout < ACHORDION_ADAPTIVE_MIN_TIMEOUT ||
+      streak_timeout > MAX_STREAK_TIMEOUT) {
+    streak_timeout = MAX_STREAK_TIMEOUT;
+  }
+#else
+  const uint16_t streak_timeout = MAX_STREAK_TIMEOUT;
+#endif  // ACHORDION_ADAPTIVE
   if (streak_timer &&
-      timer_expired(timer_read(), (streak_timer + MAX_STREAK_TIMEOUT))) {
+      timer_expired(timer_read(), (streak_timer + streak_timeout))) {
     streak_timer = 0;  // Expired.
   }
 #endif
+
+#ifdef ACHORDION_ADAPTIVE
+  adaptive_task();
+#endif  // ACHORDION_ADAPTIVE
 }
 
 // Returns true if `pos` on the left hand of the keyboard, false if right.
@@ -329,18 +1177,52 @@ bool achordion_opposite_hands(const keyrecord_t* tap_hold_record,
          on_left_hand(other_record->event.key);
 }
 
-// By default, use the BILATERAL_COMBINATIONS rule to consider the tap-hold key
-// "held" only when it and the other key are on opposite hands.
+bool achordion_default_chord(uint16_t tap_hold_keycode,
+                             keyrecord_t* tap_hold_record,
+                             uint16_t other_keycode,
+                             keyrecord_t* other_record) {
+#ifdef ACHORDION_DATA
+  const uint8_t chord_index =
+      read_data_byte(achordion_chord_index_data, tap_hold_record->event.key);
+  const int16_t other = data_index(other_record->event.key);
+  if (chord_index != DATA_UNSET_BYTE && other >= 0) {
+    // Look up the bit for the other key in the tap-hold key's row.
+    return (pgm_read_byte(achordion_chord_data +
+                          chord_index * ACHORDION_DATA_CHORD_BYTES +
+                          (other >> 3)) >>
+            (other & 7)) &
+           1;
+  }
+#endif  // ACHORDION_DATA
+#ifdef ACHORDION_CLASSIFIER
+  // The classifier needs the rhythm features of the queued tap-hold key.
+  for (uint8_t i = 0; i < queue_size; ++i) {
+    if (&queue[i].record == tap_hold_record) {
+      return classify_chord(&queue[i], other_keycode, other_record);
+    }
+  }
+#endif  // ACHORDION_CLASSIFIER
+  // Use the BILATERAL_COMBINATIONS rule to consider the tap-hold key "held"
+  // only when it and the other key are on opposite hands.
+  return achordion_opposite_hands(tap_hold_record, other_record);
+}
+
 __attribute__((weak)) bool achordion_chord(uint16_t tap_hold_keycode,
                                            keyrecord_t* tap_hold_record,
                                            uint16_t other_keycode,
                                            keyrecord_t* other_record) {
-  return achordion_opposite_hands(tap_hold_record, other_record);
+  return achordion_default_chord(tap_hold_keycode, tap_hold_record,
+                                 other_keycode, other_record);
 }
 
-// By default, the timeout is 1000 ms for all keys.
+// By default, the timeout is 1000 ms for all keys, or with ACHORDION_DATA, as
+// given by the tables.
 __attribute__((weak)) uint16_t achordion_timeout(uint16_t tap_hold_keycode) {
-  return 1000;
+#ifdef ACHORDION_DATA
+  return ACHORDION_USE_DATA;
+#else
+  return DEFAULT_TIMEOUT;
+#endif  // ACHORDION_DATA
 }
 
 // By default, Shift and Ctrl mods are eager, and Alt and GUI are not.
@@ -348,6 +1230,23 @@ __attribute__((weak)) bool achordion_eager_mod(uint8_t mod) {
   return (mod & (MOD_LALT | MOD_LGUI)) == 0;
 }
 
+// By default, no layers are eager.
+__attribute__((weak)) bool achordion_eager_layer(uint8_t layer) {
+  return false;
+}
+
+#ifdef ACHORDION_SPECULATIVE
+// By default, mod-tap keys whose tap keycode is a letter are speculative.
+__attribute__((weak)) bool achordion_speculative_tap(uint16_t tap_hold_keycode,
+                                                     keyrecord_t* record) {
+  if (!IS_QK_MOD_TAP(tap_hold_keycode)) {
+    return false;
+  }
+  const uint8_t tap_keycode = QK_MOD_TAP_GET_TAP_KEYCODE(tap_hold_keycode);
+  return KC_A <= tap_keycode && tap_keycode <= KC_Z;
+}
+#endif  // ACHORDION_SPECULATIVE
+
 #ifdef ACHORDION_STREAK
 __attribute__((weak)) bool achordion_streak_continue(uint16_t keycode) {
   // If any mods other than shift or AltGr are held, don't continue the streak
@@ -357,21 +1256,50 @@ __attribute__((weak)) bool achordion_streak_continue(uint16_t keycode) {
   if (IS_QK_MOD_TAP(keycode)) keycode = QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
   if (IS_QK_LAYER_TAP(keycode)) keycode = QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
   // Regular letters and punctuation continue the streak.
-  if (keycode >= KC_A && keycode <= KC_Z) return true;
-  switch (keycode) {
-    case KC_DOT:
-    case KC_COMMA:
-    case KC_QUOTE:
-    case KC_SPACE:
-      return true;
+  if (keycode_classes(keycode) & KEYCODE_CLASS_LETTER) return true;
+  if (keycode == KC_DOT || keycode == KC_COMMA || keycode == KC_QUOTE ||
+      keycode == KC_SPACE) {
+    return true;
   }
   // All other keys end the streak
   return false;
 }
 
+#ifdef ACHORDION_STREAK_BIGRAMS
+// Returns the letter index 0-25 of the tap keycode, or 255 if not a letter.
+static uint8_t bigram_letter(uint16_t keycode) {
+  if (IS_QK_MOD_TAP(keycode)) keycode = QK_MOD_TAP_GET_TAP_KEYCODE(keycode);
+  if (IS_QK_LAYER_TAP(keycode)) keycode = QK_LAYER_TAP_GET_TAP_KEYCODE(keycode);
+  return (KC_A <= keycode && keycode <= KC_Z) ? keycode - KC_A : 255;
+}
+
+uint16_t achordion_streak_bigram_timeout(uint16_t tap_hold_keycode,
+                                         uint16_t next_keycode) {
+  const uint8_t a = bigram_letter(tap_hold_keycode);
+  const uint8_t b = bigram_letter(next_keycode);
+  if (a == 255 || b == 255) {
+    return ACHORDION_STREAK_BIGRAM_DEFAULT;
+  }
+
+  // The table packs a 4-bit timeout level per bigram, two per byte.
+  const uint16_t i = a * 26 + b;
+  const uint8_t byte = pgm_read_byte(achordion_streak_bigram_data + i / 2);
+  const uint8_t level = (i & 1) ? (byte >> 4) : (byte & 15);
+  return level ? ACHORDION_STREAK_BIGRAM_MIN +
+                     (level - 1) * ACHORDION_STREAK_BIGRAM_STEP
+               : 0;
+}
+#endif  // ACHORDION_STREAK_BIGRAMS
+
 __attribute__((weak)) uint16_t achordion_streak_chord_timeout(
     uint16_t tap_hold_keycode, uint16_t next_keycode) {
+#if defined(ACHORDION_DATA)
+  return ACHORDION_USE_DATA;
+#elif defined(ACHORDION_STREAK_BIGRAMS)
+  return achordion_streak_bigram_timeout(tap_hold_keycode, next_keycode);
+#else
   return achordion_streak_timeout(tap_hold_keycode);
+#endif
 }
 
 __attribute__((weak)) uint16_t
@@ -39,12 +39,21 @@
  * Achordion only changes the behavior when QMK considered the key held. It
  * changes some would-be holds to taps, but no taps to holds.
  *
+ * Several tap-hold keys may be unsettled at once, as in a fast roll across
+ * home row mods. Achordion queues them and settles them strictly in the order
+ * they were pressed. When another key is pressed, each queued key is settled
+ * by `achordion_chord()` against that key. When a queued key is released
+ * before the keys pressed after it are settled, it is settled as tapped.
+ *
  * @note Some QMK features handle events before the point where Achordion can
  * intercept them, particularly: Combos, Key Lock, and Dynamic Macros. It's
  * still possible to use these features and Achordion in your keymap, but beware
  * they might behave poorly when used simultaneously with tap-hold keys.
  *
  *
+ * @note With ACHORDION_STREAK, add `SRC += features/keycode_classes.c` in
+ * rules.mk, which this uses to classify keycodes.
+ *
  * For full documentation, see
  * <https://getreuer.info/posts/keyboards/achordion>
  */
@@ -57,6 +66,32 @@
 extern "C" {
 #endif
 
+// The maximum number of tap-hold keys that Achordion tracks at once, including
+// keys that are settled but not yet released. When the queue is full, the
+// unsettled keys are settled as held.
+//
+// Only the tap-hold keys are queued. Events of other keys are never buffered
+// behind them, and this is deliberate: a press of another key settles all the
+// unsettled keys before it is processed, so it is sent after them, and a
+// release of another key passes through, since that key's press was already
+// sent. Events are therefore sent in the order they happened, and other keys
+// are sent without delay.
+#ifndef ACHORDION_QUEUE_SIZE
+#define ACHORDION_QUEUE_SIZE 4
+#endif  // ACHORDION_QUEUE_SIZE
+
+// With TAP_CODE_DELAY > 0, the release of each tap that Achordion sends is
+// scheduled TAP_CODE_DELAY ms after the press rather than waited for, and sent
+// by `achordion_task()`. It is sent early if another key is pressed first, so
+// that the host never sees a tap's release after a key pressed after it.
+//
+// Otherwise, a tap's release is sent on the first `achordion_task()` call after
+// TAP_CODE_DELAY elapses, so the press-to-release time can run longer by up to
+// a matrix scan. To measure it, enable the debug console (`CONSOLE_ENABLE =
+// yes` in rules.mk and `debug_enable = true;` in `keyboard_post_init_user()`)
+// and watch the lines "Achordion: Plumbing tap release, N ms after press.",
+// where N is the time from sending the press to sending the release.
+
 /**
  * Handler function for Achordion.
  *
@@ -99,6 +134,9 @@ void achordion_task(void);
  * `other_keycode` is pressed. Return true if the tap-hold key should be
  * considered held, or false to consider it tapped.
  *
+ * The default callback returns `achordion_default_chord()`. Return it from
+ * your callback for the keys that you don't handle specially.
+ *
  * @param tap_hold_keycode Keycode of the tap-hold key.
  * @param tap_hold_record keyrecord_t from the tap-hold press event.
  * @param other_keycode Keycode of the other key.
@@ -108,6 +146,18 @@ void achordion_task(void);
 bool achordion_chord(uint16_t tap_hold_keycode, keyrecord_t* tap_hold_record,
                      uint16_t other_keycode, keyrecord_t* other_record);
 
+/**
+ * The default chord decision, as made when `achordion_chord()` is not defined.
+ *
+ * With ACHORDION_DATA, this is the chord table for keys that the policy
+ * specifies. Otherwise, it is the classifier with ACHORDION_CLASSIFIER, or
+ * else `achordion_opposite_hands()`. The args are as for `achordion_chord()`.
+ */
+bool achordion_default_chord(uint16_t tap_hold_keycode,
+                             keyrecord_t* tap_hold_record,
+                             uint16_t other_keycode,
+                             keyrecord_t* other_record);
+
 /**
  * Optional callback to define a timeout duration per keycode.
  *
@@ -120,7 +170,10 @@ bool achordion_chord(uint16_t tap_hold_keycode, keyrecord_t* tap_hold_record,
  * The callback determines Achordion's timeout duration for `tap_hold_keycode`
  * in units of milliseconds. The timeout be in the range 0 to 32767 ms (upper
  * bound is due to 16-bit timer limitations). Use a timeout of 0 to bypass
- * Achordion.
+ * Achordion for the key. Its press still settles any earlier unsettled keys
+ * against it with `achordion_chord()`, like a press of a regular key. With
+ * ACHORDION_DATA, return ACHORDION_USE_DATA to use the timeout from the
+ * tables, which is what the default callback does.
  *
  * @param tap_hold_keycode Keycode of the tap-hold key.
  * @return Timeout duration in milliseconds in the range 0 to 32767.
@@ -149,6 +202,76 @@ uint16_t achordion_timeout(uint16_t tap_hold_keycode);
  */
 bool achordion_eager_mod(uint8_t mod);
 
+/**
+ * Optional callback defining which layers are "eagerly" activated.
+ *
+ * Like `achordion_eager_mod()` for mod-tap keys, this callback defines for
+ * layer-tap keys whether the layer is activated immediately on press, while
+ * the key is still being settled. Keys pressed meanwhile are then looked up on
+ * the layer, reducing latency when entering symbols on a layer-tap key. If the
+ * layer-tap key is settled as tapped, the layer is rolled back, and the other
+ * keys are looked up on the layers below. A typing streak is checked with the
+ * keycode on the layers below.
+ *
+ * The layer is eagerly activated only if no earlier tap-hold key is unsettled.
+ * Define this callback in your keymap.c. The default callback is false for
+ * all layers:
+ *
+ *     bool achordion_eager_layer(uint8_t layer) {
+ *       return layer == SYM;
+ *     }
+ *
+ * @param layer Layer of the layer-tap key.
+ * @return True if the layer should be eagerly activated.
+ */
+bool achordion_eager_layer(uint8_t layer);
+
+/**
+ * Speculative taps. Define ACHORDION_SPECULATIVE in config.h to enable.
+ *
+ * Normally, a tap-hold key's tap is sent only once Achordion settles it, on
+ * the next key press or release. With speculative taps, the tap is sent as
+ * soon as Achordion receives the key press. If the key is later settled as
+ * held, the tap is undone with a backspace before the hold is applied. This
+ * hides the settling delay when typing, at the cost of a briefly visible
+ * letter when using the key as a modifier.
+ *
+ * The tap is sent only if no earlier tap-hold key is unsettled and no mods
+ * other than Shift are active. A speculated key doesn't apply eager mods. The
+ * tap is plumbed through the usual event handling, so that Caps Word and other
+ * features see it, and when retracted, Repeat Key's last key is restored.
+ *
+ * The backspace is sent with Shift cleared. With REPEAT_KEY_ENABLE or
+ * COMBO_ENABLE, under which QMK records carry a keycode, it is also plumbed
+ * through the usual event handling, so that features that track the typed
+ * text, like Autocorrection and Sentence Case, forget the retracted letter.
+ * Otherwise it is sent directly with `tap_code()`, which those features don't
+ * see.
+ *
+ * @note QMK's tapping term still applies before Achordion receives the press.
+ * Speculative taps remove the additional wait for Achordion's decision.
+ *
+ * Define this callback in your keymap.c to choose which keys are eligible. The
+ * default callback is true for mod-tap keys with a letter A-Z as the tap:
+ *
+ *     bool achordion_speculative_tap(uint16_t tap_hold_keycode,
+ *                                    keyrecord_t* record) {
+ *       switch (tap_hold_keycode) {
+ *         case HOME_A:
+ *         case HOME_S:
+ *           return true;
+ *       }
+ *       return false;
+ *     }
+ *
+ * @param tap_hold_keycode Keycode of the tap-hold key.
+ * @param record keyrecord_t for the tap-hold event.
+ * @return True if the tap should be sent speculatively.
+ */
+#ifdef ACHORDION_SPECULATIVE
+bool achordion_speculative_tap(uint16_t tap_hold_keycode, keyrecord_t* record);
+#endif  // ACHORDION_SPECULATIVE
+
 /**
  * Returns true if the args come from keys on opposite hands.
  *
@@ -182,12 +305,224 @@ bool achordion_opposite_hands(const keyrecord_t* tap_hold_record,
 uint16_t achordion_streak_chord_timeout(uint16_t tap_hold_keycode,
                                         uint16_t next_keycode);
 
+/**
+ * Optional callback to determine whether pressing `keycode` continues a typing
+ * streak. By default, letters, KC_DOT, KC_COMMA, KC_QUOTE, and KC_SPACE
+ * continue the streak, unless Ctrl, Alt, or GUI is held. All other keys end
+ * it.
+ */
 bool achordion_streak_continue(uint16_t keycode);
 
 /** @deprecated Use `achordion_streak_chord_timeout()` instead. */
 uint16_t achordion_streak_timeout(uint16_t tap_hold_keycode);
 #endif
 
+/**
+ * Per-bigram streak timeouts derived from a text corpus. Define
+ * ACHORDION_STREAK_BIGRAMS in config.h to enable, along with ACHORDION_STREAK.
+ *
+ * The table is read from "achordion_streak_data.h". The one in features/ is
+ * made from the English docs in this repo, which is a reasonable default.
+ * For a better fit, remake it from text typical of your typing with
+ * tools/count_chars.py like
+ *
+ *     python3 count_chars.py --streak_table=achordion_streak_data.h corpus.txt
+ *
+ * Frequent letter pairs, which are typed fast, get a tight streak timeout, and
+ * rare pairs a loose one. Pairs that never occur in the corpus have a timeout
+ * of zero, disabling the streak so that they may be used as hotkeys. The
+ * default `achordion_streak_chord_timeout()` then returns
+ * `achordion_streak_bigram_timeout()`, which is a constant-time table lookup.
+ * It may also be called from your own `achordion_streak_chord_timeout()`.
+ *
+ * Pairs where either key isn't a letter A-Z get the timeout
+ * ACHORDION_STREAK_BIGRAM_DEFAULT. With ACHORDION_DATA, the policy's
+ * `streak_timeout()` for the tap-hold key is an upper bound on the bigram
+ * timeout, e.g. to keep it short for Shift or 0 to disable streaks on a key.
+ */
+#if defined(ACHORDION_STREAK) && defined(ACHORDION_STREAK_BIGRAMS)
+#ifndef ACHORDION_STREAK_BIGRAM_DEFAULT
+#define ACHORDION_STREAK_BIGRAM_DEFAULT 200
+#endif  // ACHORDION_STREAK_BIGRAM_DEFAULT
+
+uint16_t achordion_streak_bigram_timeout(uint16_t tap_hold_keycode,
+                                         uint16_t next_keycode);
+#endif  // defined(ACHORDION_STREAK) && defined(ACHORDION_STREAK_BIGRAMS)
+
+/**
+ * Adaptive timeouts learned from your typing rhythm. Define ACHORDION_ADAPTIVE
+ * in config.h to enable.
+ *
+ * For each tap-hold key, Achordion keeps running averages of how long the key
+ * is held when tapped and of the gap from its press to the next key press.
+ * Once enough samples are collected, the key's timeout is reduced to twice the
+ * longer of the two, so that fast typists get shorter decision windows. The
+ * timeout from `achordion_timeout()` is the upper bound and
+ * ACHORDION_ADAPTIVE_MIN_TIMEOUT the lower bound. With ACHORDION_STREAK, the
+ * streak likewise ends after a pause of four times the average gap between
+ * key presses.
+ *
+ * The learned values are saved to EEPROM at most every
+ * ACHORDION_ADAPTIVE_SAVE_INTERVAL ms, rotating among
+ * ACHORDION_ADAPTIVE_EEPROM_SLOTS copies for wear leveling. By default, they
+ * are stored in the last ACHORDION_ADAPTIVE_EEPROM_SIZE bytes of the user
+ * datablock, which needs EECONFIG_USER_DATA_SIZE to be set large enough. The
+ * start of the datablock is left for Autocorrection's uploaded dictionary.
+ * Alternatively, define ACHORDION_ADAPTIVE_EEPROM_ADDR.
+ */
+#ifdef ACHORDION_ADAPTIVE
+#ifndef ACHORDION_ADAPTIVE_KEYS
+#define ACHORDION_ADAPTIVE_KEYS 12
+#endif  // ACHORDION_ADAPTIVE_KEYS
+#ifndef ACHORDION_ADAPTIVE_MIN_TIMEOUT
+#define ACHORDION_ADAPTIVE_MIN_TIMEOUT 100
+#endif  // ACHORDION_ADAPTIVE_MIN_TIMEOUT
+#ifndef ACHORDION_ADAPTIVE_SAVE_INTERVAL
+#define ACHORDION_ADAPTIVE_SAVE_INTERVAL 600000
+#endif  // ACHORDION_ADAPTIVE_SAVE_INTERVAL
+#ifndef ACHORDION_ADAPTIVE_EEPROM_SLOTS
+#define ACHORDION_ADAPTIVE_EEPROM_SLOTS 2
+#endif  // ACHORDION_ADAPTIVE_EEPROM_SLOTS
+// Bytes of EEPROM for the learned values, at least 8 bytes per key plus 4 for
+// each slot.
+#ifndef ACHORDION_ADAPTIVE_EEPROM_SIZE
+#define ACHORDION_ADAPTIVE_EEPROM_SIZE \
+  (ACHORDION_ADAPTIVE_EEPROM_SLOTS * (8 * ACHORDION_ADAPTIVE_KEYS + 4))
+#endif  // ACHORDION_ADAPTIVE_EEPROM_SIZE
+#ifndef ACHORDION_ADAPTIVE_EEPROM_ADDR
+#define ACHORDION_ADAPTIVE_EEPROM_OFFSET \
+  (EECONFIG_USER_DATA_SIZE - ACHORDION_ADAPTIVE_EEPROM_SIZE)
+#define ACHORDION_ADAPTIVE_EEPROM_ADDR \
+  ((uint8_t*)(EECONFIG_USER_DATABLOCK) + ACHORDION_ADAPTIVE_EEPROM_OFFSET)
+#endif  // ACHORDION_ADAPTIVE_EEPROM_ADDR
+#endif  // ACHORDION_ADAPTIVE
+
+/**
+ * Tap-hold tables generated by make_achordion_data.py. To enable, set
+ * `ACHORDION_DATA_ENABLE = yes` in rules.mk, which makes achordion_data.h from
+ * the keymap's achordion_policy.py on every build and defines ACHORDION_DATA.
+ * Or run the script yourself and define ACHORDION_DATA in config.h.
+ *
+ * The script evaluates a tap-hold policy over every matrix position of the
+ * keymap and generates achordion_data.h, holding the per-key timing values and
+ * a bit matrix of which pairs of key positions are chords. The default
+ * callbacks read the timeouts and chord decision from the tables in constant
+ * time: `achordion_timeout()` and `achordion_streak_chord_timeout()` return
+ * ACHORDION_USE_DATA, and `achordion_chord()` returns
+ * `achordion_default_chord()`. Keys that the policy leaves unspecified get
+ * the usual defaults.
+ *
+ * Callbacks defined in your keymap.c take precedence over the tables. To use
+ * the tables for the keys that they don't handle, return ACHORDION_USE_DATA
+ * from the timeout callbacks and `achordion_default_chord()` from
+ * `achordion_chord()`.
+ *
+ * The following functions read the tables to implement QMK's per-key tap-hold
+ * callbacks, like
+ *
+ *     uint16_t get_tapping_term(uint16_t keycode, keyrecord_t* record) {
+ *       return achordion_data_tapping_term(record->event.key);
+ *     }
+ *
+ * They return the defaults TAPPING_TERM, QUICK_TAP_TERM, and false for keys
+ * that the policy leaves unspecified.
+ */
+#ifdef ACHORDION_DATA
+// Returned by a timeout callback to use the value from the tables.
+#define ACHORDION_USE_DATA UINT16_MAX
+
+uint16_t achordion_data_tapping_term(keypos_t pos);
+uint16_t achordion_data_quick_tap_term(keypos_t pos);
+bool achordion_data_retro_tapping(keypos_t pos);
+#endif  // ACHORDION_DATA
+
+/**
+ * Rhythm classifier as the default chord decision. Define
+ * ACHORDION_CLASSIFIER in config.h to enable.
+ *
+ * Rather than a fixed rule like the opposite hands rule, the chord decision is
+ * made by a linear model over features of the typing rhythm: the time between
+ * the tap-hold key's press and the other key's press, the idle time before the
+ * tap-hold key was pressed, how long the previously pressed key overlapped with
+ * it, whether the keys are on opposite hands or the same row, and whether the
+ * other key is a tap-hold key. The model is trained offline from keystroke
+ * logs with make_achordion_classifier.py, which generates
+ * "achordion_classifier.h" with the fixed-point weights. Evaluating it takes
+ * six 16-bit by 8-bit multiply-adds per decision. Use tools/achordion_sim to
+ * compare its misfire rate with that of `achordion_chord()` on your logs.
+ *
+ * The classifier is evaluated by `achordion_default_chord()`, so it decides
+ * chords when `achordion_chord()` is not defined. If your keymap defines
+ * `achordion_chord()`, it is still called first. Handle your special cases
+ * there and return `achordion_default_chord()` for the rest to use the
+ * classifier. With ACHORDION_DATA, keys for which the policy specifies chords
+ * are decided by the table, and all others by the classifier.
+ */
+
+/**
+ * Telemetry of Achordion's tap-hold decisions. Define ACHORDION_TELEMETRY in
+ * config.h to enable. When not defined, the telemetry compiles to nothing.
+ *
+ * Achordion counts how often keys are settled by each outcome and keeps a
+ * histogram of the time from press to settle. Histogram bucket 0 counts
+ * settle times under 16 ms, bucket b counts times in [2^(b+3), 2^(b+4)) ms,
+ * and the last bucket counts everything longer. This is useful to tune
+ * `achordion_timeout()` and the streak timeouts from real typing.
+ *
+ * With CONSOLE_ENABLE, print the telemetry with `achordion_telemetry_print()`,
+ * e.g. from a macro key. Or read it over raw HID by calling
+ * `achordion_telemetry_raw_hid()` from `raw_hid_receive()` like
+ *
+ *     void raw_hid_receive(uint8_t* data, uint8_t length) {
+ *       if (data[0] == 'A') {
+ *         achordion_telemetry_raw_hid(data, length);
+ *         raw_hid_send(data, length);
+ *       }
+ *     }
+ *
+ * where the host sets data[1] to the page to read: page 0 has the counts as
+ * ACHORDION_NUM_OUTCOMES little-endian uint32 values starting at data[2], and
+ * page 1 + outcome has the histogram for that outcome as
+ * ACHORDION_TELEMETRY_BUCKETS little-endian uint16 values. Page 255 resets the
+ * telemetry.
+ */
+#ifdef ACHORDION_TELEMETRY
+#define ACHORDION_TELEMETRY_BUCKETS 8
+
+// Outcomes of the tap-hold decision.
+enum {
+  // Settled as held by `achordion_chord()`, or on release without another key.
+  ACHORDION_OUTCOME_HOLD,
+  // Settled as tapped, by `achordion_chord()` or by being rolled.
+  ACHORDION_OUTCOME_TAP,
+  // Settled as held because the timeout expired.
+  ACHORDION_OUTCOME_TIMEOUT,
+  // Settled as tapped within a typing streak.
+  ACHORDION_OUTCOME_STREAK,
+  // Settled as held because the queue was full, see ACHORDION_QUEUE_SIZE.
+  ACHORDION_OUTCOME_QUEUE_FULL,
+  ACHORDION_NUM_OUTCOMES,
+};
+
+typedef struct {
+  uint32_t count[ACHORDION_NUM_OUTCOMES];
+  // Press-to-settle time histograms. Buckets saturate at 65535.
+  uint16_t histogram[ACHORDION_NUM_OUTCOMES][ACHORDION_TELEMETRY_BUCKETS];
+} achordion_telemetry_t;
+
+/** Gets the telemetry collected since startup or the last reset. */
+const achordion_telemetry_t* achordion_telemetry(void);
+
+/** Resets the telemetry. */
+void achordion_telemetry_reset(void);
+
+/** Prints the telemetry to the console. */
+void achordion_telemetry_print(void);
+
+/** Fills a raw HID report with the telemetry page requested in `data[1]`. */
+void achordion_telemetry_raw_hid(uint8_t* data, uint8_t length);
+#endif  // ACHORDION_TELEMETRY
+
 #ifdef __cplusplus
 }
 #endif
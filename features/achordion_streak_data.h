@@ -0,0 +1,61 @@
+// Generated code.
+
+// Achordion streak timeouts for letter bigrams, from 12803 bigrams in:
+//   README.md
+//   CONTRIBUTING.md
+//   CODE_OF_CONDUCT.md
+//   LICENSE.txt
+// Most frequent: th or on in er ti re he an en co nd at nt it io
+//
+// Timeout levels by first letter (row) and second letter (column). Level n
+// means MIN + (n - 1) * STEP ms, and level 0 disables the streak.
+//      abcdefghijklmnopqrstuvwxyz
+//   a  07570d6060a48205045298cf60
+//   b  900060008a0790700bcf500070
+//   c  609d30057095002009c4800000
+//   d  700930d0400d00700c707db0c0
+//   e  5c5379999f0672a69235779550
+//   f  c0007900600ac040080b9000a0
+//   g  80005008800a0c9008f0a000f0
+//   h  4000200050000f600cf5c000c0
+//   i  75376660c0f571390733f50d0a
+//   j  f00060000000000f0000f00000
+//   k  fc005000a00fcf0000700000d0
+//   l  50c94b003005007c0fa97c0060
+//   m  4b005c0060888d7700908000b0
+//   n  6062574f70c8cd6f0032caf060
+//   o  7976f3a0c7f651960165387d90
+//   p  500060ffa0060b570478800080
+//   q  00000000000080000000900000
+//   r  5b762da0305c6b490877bfa090
+//   s  80af3d0650fcb0570f645000b0
+//   t  50d03d01200b8f37046680cf50
+//   u  876760f0900896fb0554000000
+//   v  70004000600000900000000000
+//   w  8d0080085000095f0bc000b000
+//   x  c0a0c00000000009000ac00000
+//   y  a8009000c00b7f5f09b00000c0
+//   z  f000b0000000000000a0000000
+
+#define ACHORDION_STREAK_BIGRAM_MIN 60
+#define ACHORDION_STREAK_BIGRAM_STEP 13
+
+static const uint8_t achordion_streak_bigram_data[338] PROGMEM = {112, 117, 208,
+  6, 6, 74, 40, 80, 64, 37, 137, 252, 6, 9, 0, 6, 0, 168, 112, 9, 7, 176, 252,
+  5, 0, 7, 6, 217, 3, 80, 7, 89, 0, 2, 144, 76, 8, 0, 0, 7, 144, 3, 13, 4, 208,
+  0, 7, 192, 7, 215, 11, 12, 197, 53, 151, 153, 249, 96, 39, 106, 41, 83, 119,
+  89, 5, 12, 0, 151, 0, 6, 160, 12, 4, 128, 176, 9, 0, 10, 8, 0, 5, 128, 8, 160,
+  192, 9, 128, 15, 10, 0, 15, 4, 0, 2, 0, 5, 0, 240, 6, 192, 95, 12, 0, 12, 87,
+  115, 102, 6, 12, 95, 23, 147, 112, 51, 95, 208, 160, 15, 0, 6, 0, 0, 0, 0,
+  240, 0, 0, 15, 0, 0, 207, 0, 5, 0, 10, 240, 252, 0, 0, 7, 0, 0, 13, 5, 156,
+  180, 0, 3, 80, 0, 199, 240, 154, 199, 0, 6, 180, 0, 197, 0, 6, 136, 216, 119,
+  0, 9, 8, 0, 11, 6, 38, 117, 244, 7, 140, 220, 246, 0, 35, 172, 15, 6, 151,
+  103, 63, 10, 124, 111, 21, 105, 16, 86, 131, 215, 9, 5, 0, 6, 255, 10, 96,
+  176, 117, 64, 135, 8, 0, 8, 0, 0, 0, 0, 0, 0, 8, 0, 0, 0, 9, 0, 0, 181, 103,
+  210, 10, 3, 197, 182, 148, 128, 119, 251, 10, 9, 8, 250, 211, 96, 5, 207, 11,
+  117, 240, 70, 5, 0, 11, 5, 13, 211, 16, 2, 176, 248, 115, 64, 102, 8, 252, 5,
+  120, 118, 6, 15, 9, 128, 105, 191, 80, 69, 0, 0, 0, 7, 0, 4, 0, 6, 0, 0, 9, 0,
+  0, 0, 0, 0, 216, 0, 8, 128, 5, 0, 144, 245, 176, 12, 0, 11, 0, 12, 10, 12, 0,
+  0, 0, 0, 144, 0, 160, 12, 0, 0, 138, 0, 9, 0, 12, 176, 247, 245, 144, 11, 0,
+  0, 12, 15, 0, 11, 0, 0, 0, 0, 0, 0, 10, 0, 0, 0};
+
@@ -24,12 +24,24 @@
 
 #include <string.h>
 
+#include "keycode_classes.h"
+
+#ifdef AUTOCORRECTION_UPLOAD
+#ifdef AUTOCORRECTION_AUTOMATON
+#error "AUTOCORRECTION_UPLOAD supports the trie, not AUTOCORRECTION_AUTOMATON."
+#endif  // AUTOCORRECTION_AUTOMATON
+#ifdef AUTOCORRECTION_LAYERS
+// Uploaded dictionaries have no layer mask in their leaves.
+#error "AUTOCORRECTION_UPLOAD does not support AUTOCORRECTION_LAYERS."
+#endif  // AUTOCORRECTION_LAYERS
+#else
 #include "autocorrection_data.h"
+#endif  // AUTOCORRECTION_UPLOAD
 
 #pragma message \
     "Autocorrect is now a core QMK feature! To use it, update your QMK set up and see https://docs.qmk.fm/features/autocorrect"
 
-#if AUTOCORRECTION_MIN_LENGTH < 4
+#if !defined(AUTOCORRECTION_UPLOAD) && AUTOCORRECTION_MIN_LENGTH < 4
 // Odd output or hard locks on the board have been observed when the min typo
 // length is 3 or lower (https://github.com/getreuer/qmk-keymap/issues/2).
 // Additionally, autocorrection entries for short typos are more likely to false
@@ -37,8 +49,317 @@
 #error "Min typo length is less than 4. Autocorrection may behave poorly."
 #endif
 
+#ifndef AUTOCORRECTION_DEFAULT_LAYERS
+#define AUTOCORRECTION_DEFAULT_LAYERS 0xFF
+#endif  // AUTOCORRECTION_DEFAULT_LAYERS
+
+// Mask of the enabled dictionary layers. See autocorrection_set_layers().
+static uint8_t autocorrection_layers = AUTOCORRECTION_DEFAULT_LAYERS;
+
+#ifdef AUTOCORRECTION_UPLOAD
+#ifdef ACHORDION_ADAPTIVE
+// Achordion's adaptive timeouts are also saved in EEPROM.
+#include "achordion.h"
+#endif  // ACHORDION_ADAPTIVE
+
+#ifndef AUTOCORRECTION_EEPROM_ADDR
+// By default, the dictionary is at the start of the user datablock. With
+// ACHORDION_ADAPTIVE, the end of the datablock is left for Achordion.
+#define AUTOCORRECTION_EEPROM_ADDR EECONFIG_USER_DATABLOCK
+#ifdef ACHORDION_ADAPTIVE
+#define AUTOCORRECTION_EEPROM_SIZE \
+  (EECONFIG_USER_DATA_SIZE - ACHORDION_ADAPTIVE_EEPROM_SIZE)
+#else
+#define AUTOCORRECTION_EEPROM_SIZE EECONFIG_USER_DATA_SIZE
+#endif  // ACHORDION_ADAPTIVE
+#endif  // AUTOCORRECTION_EEPROM_ADDR
+#ifndef AUTOCORRECTION_EEPROM_SIZE
+#error "Define AUTOCORRECTION_EEPROM_SIZE with AUTOCORRECTION_EEPROM_ADDR."
+#endif  // AUTOCORRECTION_EEPROM_SIZE
+
+#ifdef ACHORDION_ADAPTIVE
+_Static_assert(
+    (uintptr_t)(AUTOCORRECTION_EEPROM_ADDR) + AUTOCORRECTION_EEPROM_SIZE <=
+            (uintptr_t)(ACHORDION_ADAPTIVE_EEPROM_ADDR) ||
+        (uintptr_t)(ACHORDION_ADAPTIVE_EEPROM_ADDR) +
+                ACHORDION_ADAPTIVE_EEPROM_SIZE <=
+            (uintptr_t)(AUTOCORRECTION_EEPROM_ADDR),
+    "autocorrection: The EEPROM areas of AUTOCORRECTION_UPLOAD and "
+    "ACHORDION_ADAPTIVE overlap.");
+#endif  // ACHORDION_ADAPTIVE
+
+// Format flags of the dictionaries that this firmware can read.
+static const uint8_t supported_flags = 0
+#ifdef AUTOCORRECTION_BITMAP_NODES
+                                       | AUTOCORRECTION_FLAG_BITMAP_NODES
+#endif  // AUTOCORRECTION_BITMAP_NODES
+#ifdef AUTOCORRECTION_IDENTIFIERS
+                                       | AUTOCORRECTION_FLAG_IDENTIFIERS
+#endif  // AUTOCORRECTION_IDENTIFIERS
+    ;
+
+// Reads byte `i` of the uploaded trie data, which follows the header.
+#define AUTOCORRECTION_READ(i)                                    \
+  eeprom_read_byte((const uint8_t*)(AUTOCORRECTION_EEPROM_ADDR) + \
+                   AUTOCORRECTION_HEADER_SIZE + (i))
+#define AUTOCORRECTION_DATA_SIZE uploaded_size
+
+// Size of the trie data of the uploaded dictionary, or 0 if there is no valid
+// dictionary. Along with its min typo length and format flags, this is read
+// from the header on the first key press and after each upload.
+static uint16_t uploaded_size = 0;
+static uint8_t uploaded_min_length = 0;
+static uint8_t uploaded_flags = 0;
+static bool uploaded_checked = false;
+// Total size of the upload in progress, or 0 if none.
+static uint16_t upload_size = 0;
+
+// Updates `crc` with `byte`, for CRC-16/CCITT-FALSE (polynomial 0x1021, initial
+// value 0xFFFF).
+static uint16_t crc16_update(uint16_t crc, uint8_t byte) {
+  crc ^= (uint16_t)byte << 8;
+  for (uint8_t i = 0; i < 8; ++i) {
+    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+// Checks the header and CRC of the dictionary in EEPROM, and if valid, makes it
+// the dictionary in use. Returns an AUTOCORRECTION_UPLOAD_* status.
+static uint8_t check_uploaded(void) {
+  uint8_t header[AUTOCORRECTION_HEADER_SIZE];
+  eeprom_read_block(header, (const void*)(AUTOCORRECTION_EEPROM_ADDR),
+                    sizeof(header));
+  uploaded_checked = true;
+  uploaded_size = 0;
+
+  const uint16_t size = header[4] | (uint16_t)header[5] << 8;
+  if (header[0] != AUTOCORRECTION_FORMAT_VERSION ||
+      (header[1] & ~supported_flags) != 0 || header[2] < 4 ||
+      header[2] > header[3] || header[3] > AUTOCORRECTION_MAX_LENGTH ||
+      size == 0 ||
+      size > AUTOCORRECTION_EEPROM_SIZE - AUTOCORRECTION_HEADER_SIZE) {
+    return AUTOCORRECTION_UPLOAD_BAD_HEADER;
+  }
+
+  uint16_t crc = 0xFFFF;
+  for (uint16_t i = 0; i < size; ++i) {
+    crc = crc16_update(crc, AUTOCORRECTION_READ(i));
+  }
+  if (crc != (header[6] | (uint16_t)header[7] << 8)) {
+    return AUTOCORRECTION_UPLOAD_BAD_CRC;
+  }
+
+  uploaded_size = size;
+  uploaded_min_length = header[2];
+  uploaded_flags = header[1];
+  dprintf("Autocorrection: Using uploaded dictionary of %u bytes.\n", size);
+  return AUTOCORRECTION_UPLOAD_OK;
+}
+
+// Sends the correction of the leaf at `state` in the uploaded data, like
+// send_correction() below, but reading from EEPROM.
+static void send_uploaded_correction(uint16_t state) {
+  const uint8_t code = AUTOCORRECTION_READ(state);
+  for (uint8_t i = code & 63; i > 0; --i) {
+    tap_code(KC_BSPC);
+  }
+
+  uint16_t string = state + 1;
+  if (code & 64) {
+    string = AUTOCORRECTION_READ(state + 1) |
+             (uint16_t)AUTOCORRECTION_READ(state + 2) << 8;
+  }
+  for (char c; string < uploaded_size && (c = AUTOCORRECTION_READ(string));
+       ++string) {
+    send_char(c);
+  }
+}
+#else
+#define AUTOCORRECTION_READ(i) pgm_read_byte(autocorrection_data + (i))
+#define AUTOCORRECTION_DATA_SIZE sizeof(autocorrection_data)
+
+#ifdef AUTOCORRECTION_PACKED_STRINGS
+// Characters of packed strings for codes 27 to 30, after a-z for 1 to 26.
+static const char packed_chars[4] PROGMEM = {'\'', ' ', '_', '-'};
+
+// Sends the string packed at `string` in `data`, decoding as it goes. The
+// string is 5-bit codes, most significant bit first, ending with code 0. Code
+// 31 is an escape, followed by a character in 8 bits.
+static void send_packed_string(const uint8_t* data, uint16_t string) {
+  uint_fast16_t bits = 0;  // Bits read but not yet decoded, the low `n` bits.
+  uint8_t n = 0;
+  bool escape = false;
+  for (;;) {
+    const uint8_t width = escape ? 8 : 5;
+    if (n < width) {
+      bits = (bits << 8) | pgm_read_byte(data + string++);
+      n += 8;
+    }
+    n -= width;
+    const uint8_t code = (bits >> n) & ((1 << width) - 1);
+
+    if (escape) {
+      send_char((char)code);
+      escape = false;
+    } else if (code == 0) {
+      return;
+    } else if (code == 31) {
+      escape = true;
+    } else if (code <= 26) {
+      send_char('a' - 1 + code);
+    } else {
+      send_char(pgm_read_byte(packed_chars + (code - 27)));
+    }
+  }
+}
+#endif  // AUTOCORRECTION_PACKED_STRINGS
+
+#ifdef AUTOCORRECTION_LAYERS
+// With layered dictionaries, leaves have the layer mask after the backspaces.
+#define AUTOCORRECTION_LEAF_HEADER_SIZE 2
+#else
+#define AUTOCORRECTION_LEAF_HEADER_SIZE 1
+#endif  // AUTOCORRECTION_LAYERS
+
+// Sends the correction of the leaf at `state` in `data`, which is a number of
+// backspaces followed by a string. If bit 64 is set, the string is in the pool
+// at the end of `data`, and the leaf has a link to it instead.
+static void send_correction(const uint8_t* data, uint16_t state) {
+  const uint8_t code = pgm_read_byte(data + state);
+  const int backspaces = code & 63;
+  for (int i = 0; i < backspaces; ++i) {
+    tap_code(KC_BSPC);
+  }
+
+  uint16_t string = state + AUTOCORRECTION_LEAF_HEADER_SIZE;
+  if (code & 64) {
+    string = (uint16_t)((uint_fast16_t)pgm_read_byte(data + string) |
+                        (uint_fast16_t)pgm_read_byte(data + string + 1) << 8);
+  }
+#ifdef AUTOCORRECTION_PACKED_STRINGS
+  send_packed_string(data, string);
+#else
+  send_string_P((char const*)(data + string));
+#endif  // AUTOCORRECTION_PACKED_STRINGS
+}
+#endif  // AUTOCORRECTION_UPLOAD
+
+#ifdef AUTOCORRECTION_IDENTIFIERS
+// Code of '_' in the buffer and data, which is typed as shifted KC_MINS. The
+// value is unused by keycodes.
+#define AUTOCORRECTION_UNDERSCORE 2
+
+// If `keycode` types one of the identifier symbols 0-9, '_', '-', or '.',
+// returns its code in the buffer. Otherwise returns KC_NO.
+static uint8_t identifier_code(uint8_t keycode, bool shifted) {
+#ifdef AUTOCORRECTION_UPLOAD
+  if (!(uploaded_flags & AUTOCORRECTION_FLAG_IDENTIFIERS)) {
+    return KC_NO;  // The uploaded dictionary has no identifier symbols.
+  }
+#endif  // AUTOCORRECTION_UPLOAD
+  if (keycode == KC_MINS) {
+    return shifted ? AUTOCORRECTION_UNDERSCORE : KC_MINS;
+  } else if (!shifted &&
+             ((KC_1 <= keycode && keycode <= KC_0) || keycode == KC_DOT)) {
+    return keycode;
+  }
+  return KC_NO;
+}
+#endif  // AUTOCORRECTION_IDENTIFIERS
+
+#if defined(AUTOCORRECTION_AUTOMATON) || \
+    defined(AUTOCORRECTION_BITMAP_NODES) || defined(AUTOCORRECTION_QUICK_REJECT)
+// Returns the index of `keycode` among the symbols of the automaton, bitmap
+// nodes, and quick reject: a-z, ', the word break, and with
+// AUTOCORRECTION_IDENTIFIERS, digits 1-9, 0, '_', '-', and '.'.
+static uint8_t autocorrection_symbol(uint8_t keycode) {
+  switch (keycode) {
+    case KC_QUOT:
+      return 26;
+    case KC_SPC:
+      return 27;
+#ifdef AUTOCORRECTION_IDENTIFIERS
+    case KC_1 ... KC_0:
+      return 28 + (keycode - KC_1);
+    case AUTOCORRECTION_UNDERSCORE:
+      return 38;
+    case KC_MINS:
+      return 39;
+    case KC_DOT:
+      return 40;
+#endif  // AUTOCORRECTION_IDENTIFIERS
+    default:
+      return keycode - KC_A;
+  }
+}
+#endif  // defined(AUTOCORRECTION_AUTOMATON) || ...
+
+#ifdef AUTOCORRECTION_QUICK_REJECT
+#ifdef AUTOCORRECTION_IDENTIFIERS
+#define AUTOCORRECTION_NUM_SYMBOLS 41
+#else
+#define AUTOCORRECTION_NUM_SYMBOLS 28
+#endif  // AUTOCORRECTION_IDENTIFIERS
+
+// Returns whether a typo may end with the keys `previous`, `last`, looked up in
+// the bitset of the symbol pairs that typos end with.
+static bool quick_reject_passes(uint8_t previous, uint8_t last) {
+  const uint16_t i =
+      autocorrection_symbol(last) * AUTOCORRECTION_NUM_SYMBOLS +
+      autocorrection_symbol(previous);
+  return pgm_read_byte(autocorrection_quick_reject + (i >> 3)) & (1 << (i & 7));
+}
+#endif  // AUTOCORRECTION_QUICK_REJECT
+
+#ifdef AUTOCORRECTION_BITMAP_NODES
+// Size of the bitmap of a bitmap node, one bit per symbol.
+#if defined(AUTOCORRECTION_UPLOAD) && defined(AUTOCORRECTION_IDENTIFIERS)
+#define AUTOCORRECTION_BITMAP_BYTES \
+  ((uploaded_flags & AUTOCORRECTION_FLAG_IDENTIFIERS) ? 6 : 4)
+#elif defined(AUTOCORRECTION_IDENTIFIERS)
+#define AUTOCORRECTION_BITMAP_BYTES 6
+#else
+#define AUTOCORRECTION_BITMAP_BYTES 4
+#endif  // AUTOCORRECTION_IDENTIFIERS
+#endif  // AUTOCORRECTION_BITMAP_NODES
+
+#ifdef AUTOCORRECTION_AUTOMATON
+// Makes the automaton transition from `state` on `keycode`. A state lists the
+// transitions that differ from the root's, sorted by symbol, and otherwise the
+// transition is read from the row of the root's transitions at offset 1.
+static uint16_t automaton_transition(uint16_t state, uint8_t keycode) {
+  const uint8_t symbol = autocorrection_symbol(keycode);
+  uint8_t n = pgm_read_byte(autocorrection_automaton + state);
+  uint16_t link = 1 + 2 * symbol;
+
+  for (++state; n; --n, state += 3) {
+    const uint8_t code = pgm_read_byte(autocorrection_automaton + state);
+    if (code >= symbol) {
+      if (code == symbol) {
+        link = state + 1;
+      }
+      break;
+    }
+  }
+
+  return (uint16_t)((uint_fast16_t)pgm_read_byte(autocorrection_automaton +
+                                                 link) |
+                    (uint_fast16_t)pgm_read_byte(autocorrection_automaton +
+                                                 link + 1)
+                        << 8);
+}
+#endif  // AUTOCORRECTION_AUTOMATON
+
 bool process_autocorrection(uint16_t keycode, keyrecord_t* record) {
+#ifdef AUTOCORRECTION_AUTOMATON
+  // With the automaton, the buffer is a ring of the states after each of the
+  // last keys, so that the state can be restored on backspace.
+  static uint16_t typo_buffer[AUTOCORRECTION_MAX_LENGTH] = {0};
+  static uint8_t typo_buffer_start = 0;
+#else
   static uint8_t typo_buffer[AUTOCORRECTION_MAX_LENGTH] = {0};
+#endif  // AUTOCORRECTION_AUTOMATON
   static uint8_t typo_buffer_size = 0;
 
   // Ignore key release; we only process key presses.
@@ -46,6 +367,15 @@ bool process_autocorrection(uint16_t keycode, keyrecord_t* record) {
     return true;
   }
 
+#ifdef AUTOCORRECTION_UPLOAD
+  if (!uploaded_checked) {
+    check_uploaded();
+  }
+  if (!uploaded_size) {
+    return true;  // No dictionary has been uploaded.
+  }
+#endif  // AUTOCORRECTION_UPLOAD
+
 #ifndef NO_ACTION_ONESHOT
   const uint8_t mods = get_mods() | get_oneshot_mods();
 #else
@@ -57,6 +387,13 @@ bool process_autocorrection(uint16_t keycode, keyrecord_t* record) {
     return true;
   }
 
+#ifdef AUTOCORRECTION_IDENTIFIERS
+  // Whether the key types a shifted symbol, to tell '_' = S(KC_MINS) from '-'.
+  const bool shifted = (mods & MOD_MASK_SHIFT) != 0 ||
+                       (QK_LSFT <= keycode && keycode <= QK_LSFT + 255) ||
+                       (QK_RSFT <= keycode && keycode <= QK_RSFT + 255);
+#endif  // AUTOCORRECTION_IDENTIFIERS
+
   // The following switch cases address various kinds of keycodes. This logic is
   // split over two switches rather than merged into one. The first switch may
   // extract a basic keycode which is then further handled by the second switch,
@@ -106,19 +443,25 @@ bool process_autocorrection(uint16_t keycode, keyrecord_t* record) {
       return true;  // Ignore these keys.
   }
 
+  const uint8_t classes = keycode_classes(keycode);
   if (keycode == KC_QUOT) {
     // Treat " (shifted ') as a word boundary.
     if ((mods & MOD_MASK_SHIFT) != 0) {
       keycode = KC_SPC;
     }
-  } else if (!(KC_A <= keycode && keycode <= KC_Z)) {
+  } else if (!(classes & KEYCODE_CLASS_LETTER)) {
     if (keycode == KC_BSPC) {
       // Remove last character from the buffer.
       if (typo_buffer_size > 0) {
         --typo_buffer_size;
       }
       return true;
-    } else if (KC_1 <= keycode && keycode <= KC_SLSH && keycode != KC_ESC) {
+#ifdef AUTOCORRECTION_IDENTIFIERS
+    } else if (identifier_code(keycode, shifted) != KC_NO) {
+      // Buffer identifier symbols as themselves rather than as word breaks.
+      keycode = identifier_code(keycode, shifted);
+#endif  // AUTOCORRECTION_IDENTIFIERS
+    } else if (classes & KEYCODE_CLASS_WORD_BREAK) {
       // Set a word boundary if space, period, digit, etc. is pressed.
       // Behave more conservatively for the enter key. Reset, so that enter
       // can't be used on a word ending.
@@ -133,6 +476,49 @@ bool process_autocorrection(uint16_t keycode, keyrecord_t* record) {
     }
   }
 
+#ifdef AUTOCORRECTION_AUTOMATON
+  // Make one transition from the state of the previous key.
+  uint8_t i = typo_buffer_start + typo_buffer_size - 1;
+  if (i >= AUTOCORRECTION_MAX_LENGTH) {
+    i -= AUTOCORRECTION_MAX_LENGTH;
+  }
+  const uint16_t state =
+      automaton_transition(typo_buffer_size ? typo_buffer[i] : 0, keycode);
+
+  // Append `state` to the ring, discarding the oldest state if it is full.
+  if (++i >= AUTOCORRECTION_MAX_LENGTH) {
+    i = 0;
+  }
+  typo_buffer[i] = state;
+  if (typo_buffer_size < AUTOCORRECTION_MAX_LENGTH) {
+    ++typo_buffer_size;
+  } else {
+    typo_buffer_start = (i + 1 < AUTOCORRECTION_MAX_LENGTH) ? i + 1 : 0;
+  }
+
+  // Stop if `state` is an invalid index, a safeguard like in the trie lookup.
+  if (state >= sizeof(autocorrection_automaton)) {
+    typo_buffer_size = 0;
+    return true;
+  }
+
+  if (pgm_read_byte(autocorrection_automaton + state) & 128) {
+    // A typo was found! Apply autocorrection.
+    send_correction(autocorrection_automaton, state);
+
+    if (keycode == KC_SPC) {
+      typo_buffer_start = 0;
+      typo_buffer[0] = automaton_transition(0, KC_SPC);
+      typo_buffer_size = 1;
+      return true;
+    } else {
+      typo_buffer_size = 0;
+      return false;
+    }
+  }
+
+  return true;
+#else
   // If the buffer is full, rotate it to discard the oldest character.
   if (typo_buffer_size >= AUTOCORRECTION_MAX_LENGTH) {
     memmove(typo_buffer, typo_buffer + 1, AUTOCORRECTION_MAX_LENGTH - 1);
@@ -143,54 +529,93 @@ bool process_autocorrection(uint16_t keycode, keyrecord_t* record) {
   // NOTE: `keycode` must be a basic keycode (0-255) by this point.
   typo_buffer[typo_buffer_size++] = (uint8_t)keycode;
   // Early return if not many characters have been buffered so far.
+#ifdef AUTOCORRECTION_UPLOAD
+  if (typo_buffer_size < uploaded_min_length) {
+#else
   if (typo_buffer_size < AUTOCORRECTION_MIN_LENGTH) {
+#endif  // AUTOCORRECTION_UPLOAD
+    return true;
+  }
+
+#ifdef AUTOCORRECTION_QUICK_REJECT
+  // Most keys end in a pair that no typo ends with. Skip the trie walk then.
+  if (typo_buffer_size >= 2 &&
+      !quick_reject_passes(typo_buffer[typo_buffer_size - 2],
+                           typo_buffer[typo_buffer_size - 1])) {
     return true;
   }
+#endif  // AUTOCORRECTION_QUICK_REJECT
 
   // Check whether the buffer ends in a typo. This is done using a trie
-  // stored in `autocorrection_data`.
+  // stored in `autocorrection_data`, or in EEPROM when uploaded.
   uint16_t state = 0;
-  uint8_t code = pgm_read_byte(autocorrection_data + state);
+  uint8_t code = AUTOCORRECTION_READ(state);
   for (int i = typo_buffer_size - 1; i >= 0; --i) {
     const uint8_t key_i = typo_buffer[i];
 
+#ifdef AUTOCORRECTION_BITMAP_NODES
+    if (code == 1) {  // Check for match in node with a bitmap of children.
+      // The node has a bitmap of which symbols have children, followed by the
+      // links to the children in order of symbol. The index of the link is the
+      // number of children before the symbol.
+      const uint8_t symbol = autocorrection_symbol(key_i);
+      const uint8_t bit = 1 << (symbol & 7);
+      const uint8_t byte = AUTOCORRECTION_READ(state + 1 + (symbol >> 3));
+      if (!(byte & bit)) {
+        return true;
+      }
+
+      uint8_t index = __builtin_popcount(byte & (bit - 1));
+      for (uint8_t j = 0; j < (symbol >> 3); ++j) {
+        index += __builtin_popcount(AUTOCORRECTION_READ(state + 1 + j));
+      }
+
+      // Follow link to child node.
+      state += 1 + AUTOCORRECTION_BITMAP_BYTES + 2 * index;
+      state = (uint16_t)((uint_fast16_t)AUTOCORRECTION_READ(state) |
+                         (uint_fast16_t)AUTOCORRECTION_READ(state + 1) << 8);
+    } else
+#endif  // AUTOCORRECTION_BITMAP_NODES
     if (code & 64) {  // Check for match in node with multiple children.
       code &= 63;
-      for (; code != key_i;
-           code = pgm_read_byte(autocorrection_data + (state += 3))) {
+      for (; code != key_i; code = AUTOCORRECTION_READ(state += 3)) {
         if (!code) {
           return true;
         }
       }
 
       // Follow link to child node.
-      state = (uint16_t)((uint_fast16_t)pgm_read_byte(autocorrection_data +
-                                                      state + 1) |
-                         (uint_fast16_t)pgm_read_byte(autocorrection_data +
-                                                      state + 2)
-                             << 8);
+      state = (uint16_t)((uint_fast16_t)AUTOCORRECTION_READ(state + 1) |
+                         (uint_fast16_t)AUTOCORRECTION_READ(state + 2) << 8);
       // Otherwise check for match in node with a single child.
     } else if (code != key_i) {
       return true;
-    } else if (!(code = pgm_read_byte(autocorrection_data + (++state)))) {
+    } else if (!(code = AUTOCORRECTION_READ(++state))) {
       ++state;
     }
 
     // Stop if `state` becomes an invalid index. This should not normally
     // happen, it is a safeguard in case of a bug, data corruption, etc.
-    if (state >= sizeof(autocorrection_data)) {
+    if (state >= AUTOCORRECTION_DATA_SIZE) {
       return true;
     }
 
     // Read first byte of the next node.
-    code = pgm_read_byte(autocorrection_data + state);
+    code = AUTOCORRECTION_READ(state);
 
     if (code & 128) {  // A typo was found! Apply autocorrection.
-      const int backspaces = code & 63;
-      for (int i = 0; i < backspaces; ++i) {
-        tap_code(KC_BSPC);
+#ifdef AUTOCORRECTION_LAYERS
+      // Ignore the typo if none of its layers are enabled. Typos are not
+      // suffixes of one another, so no other typo can match.
+      if (!(AUTOCORRECTION_READ(state + 1) & autocorrection_layers)) {
+        return true;
       }
-      send_string_P((char const*)(autocorrection_data + state + 1));
+#endif  // AUTOCORRECTION_LAYERS
+#ifdef AUTOCORRECTION_UPLOAD
+      send_uploaded_correction(state);
+#else
+      send_correction(autocorrection_data, state);
+#endif  // AUTOCORRECTION_UPLOAD
 
       if (keycode == KC_SPC) {
         typo_buffer[0] = KC_SPC;
@@ -204,4 +629,83 @@ bool process_autocorrection(uint16_t keycode, keyrecord_t* record) {
   }
 
   return true;
+#endif  // AUTOCORRECTION_AUTOMATON
+}
+
+void autocorrection_set_layers(uint8_t layers) {
+  autocorrection_layers = layers;
+}
+
+uint8_t autocorrection_get_layers(void) { return autocorrection_layers; }
+
+#ifdef AUTOCORRECTION_UPLOAD
+void autocorrection_upload_raw_hid(uint8_t* data, uint8_t length) {
+  const uint8_t command = data[1];
+  uint8_t status = AUTOCORRECTION_UPLOAD_OK;
+
+  switch (command) {
+    case AUTOCORRECTION_UPLOAD_INFO:
+      if (!uploaded_checked) {
+        check_uploaded();
+      }
+      memset(data + 3, 0, length - 3);
+      data[3] = AUTOCORRECTION_FORMAT_VERSION;
+      data[4] = supported_flags;
+      data[5] = (uint8_t)AUTOCORRECTION_EEPROM_SIZE;
+      data[6] = (uint8_t)(AUTOCORRECTION_EEPROM_SIZE >> 8);
+      data[7] = AUTOCORRECTION_MAX_LENGTH;
+      if (uploaded_size) {  // Report the header of the dictionary in use.
+        eeprom_read_block(data + 8, (const void*)(AUTOCORRECTION_EEPROM_ADDR),
+                          AUTOCORRECTION_HEADER_SIZE);
+      }
+      break;
+
+    case AUTOCORRECTION_UPLOAD_BEGIN: {
+      const uint16_t size = data[3] | (uint16_t)data[4] << 8;
+      if (size <= AUTOCORRECTION_HEADER_SIZE ||
+          size > AUTOCORRECTION_EEPROM_SIZE) {
+        status = AUTOCORRECTION_UPLOAD_BAD_SIZE;
+        break;
+      }
+      // Invalidate the stored dictionary until the upload is complete.
+      eeprom_update_byte((uint8_t*)(AUTOCORRECTION_EEPROM_ADDR), 0);
+      uploaded_size = 0;
+      uploaded_checked = true;
+      upload_size = size;
+    } break;
+
+    case AUTOCORRECTION_UPLOAD_WRITE: {
+      const uint16_t offset = data[3] | (uint16_t)data[4] << 8;
+      const uint8_t n = data[5];
+      if (!upload_size) {
+        status = AUTOCORRECTION_UPLOAD_NOT_STARTED;
+      } else if (6 + n > length || offset + n > upload_size) {
+        status = AUTOCORRECTION_UPLOAD_BAD_SIZE;
+      } else {
+        eeprom_update_block(data + 6,
+                            (uint8_t*)(AUTOCORRECTION_EEPROM_ADDR) + offset, n);
+      }
+    } break;
+
+    case AUTOCORRECTION_UPLOAD_END:
+      if (!upload_size) {
+        status = AUTOCORRECTION_UPLOAD_NOT_STARTED;
+        break;
+      }
+      status = check_uploaded();
+      // The header must account for all the uploaded bytes.
+      if (status == AUTOCORRECTION_UPLOAD_OK &&
+          uploaded_size != upload_size - AUTOCORRECTION_HEADER_SIZE) {
+        uploaded_size = 0;
+        status = AUTOCORRECTION_UPLOAD_BAD_HEADER;
+      }
+      upload_size = 0;
+      break;
+
+    default:
+      status = AUTOCORRECTION_UPLOAD_BAD_COMMAND;
+  }
+
+  data[2] = status;
 }
+#endif  // AUTOCORRECTION_UPLOAD
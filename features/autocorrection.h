@@ -36,8 +36,9 @@
  *
  * Limitations:
  *
- *  * It is limited to alphabet characters a–z, apostrophes ', and word breaks.
- *    I'm sorry this probably isn't useful for languages besides English.
+ *  * It is limited to alphabet characters a–z, apostrophes ', word breaks, and
+ *    for identifiers, digits, '_', '-', and '.'. I'm sorry this probably isn't
+ *    useful for languages besides English.
  *  * It does not follow mouse or hotkey driven cursor movement.
  *
  * Changing the autocorrection dictionary
@@ -66,19 +67,54 @@
  * character : representing a word break. The correction may have just about any
  * printable ASCII characters.
  *
+ * For typos within code identifiers, the typo may also use digits 0–9, '_',
+ * '-', and '.', like `sefl. -> self.` or `nubmer_ -> number_`. When any typo
+ * does, the script defines AUTOCORRECTION_IDENTIFIERS and these keys are
+ * matched as themselves rather than as word breaks. So that '_', '-', and '.'
+ * still end words, a typo starting or ending with : is stored once for each of
+ * them, e.g. `:thier` also as `_thier`, and the script prints the flash used.
+ *
  * Step 2: Use the make_autocorrection_data.py Python script to process the
  * dictionary. Put autocorrection_dict.txt in the same directory as the Python
  * script and run
  *
  *     $ python3 make_autocorrection_data.py
- *     Processed 71 autocorrection entries to table with 1120 bytes.
+ *     Minimized the trie from 1120 to 1107 bytes, saving 13 bytes.
+ *     Processed 71 autocorrection entries to table with 1107 bytes.
  *
  * The script arranges the entries in autocorrection_dict.txt into a trie and
  * generates autocorrection_data.h with the serialized trie embedded as an
- * array. The .h file will be written in the same directory.
+ * array. The .h file will be written in the same directory. To save flash,
+ * identical subtrees of the trie are stored once, and correction strings that
+ * are shared are stored once in a string pool.
+ *
+ * Optionally, run the script with `--automaton` to generate an automaton
+ * instead of the trie. With the trie, each key press walks backwards over the
+ * recently typed keys, while the automaton makes one transition per key press.
+ * The automaton is faster but larger, several times the size of the trie. The
+ * script prints the size and number of PROGMEM reads per key of both.
+ *
+ * Or run the script with `--bitmap_nodes` to store trie nodes with many
+ * children with a bitmap of the children, so that the child for a key is found
+ * in constant time rather than by a linear search. This is used per node where
+ * it is no larger, typically for nodes with 4 or more children.
+ *
+ * To save more flash, run the script with `--packed_strings` to store the
+ * correction strings with 5 bits per character rather than 8. Characters
+ * besides a-z, ', space, '_', and '-' take 13 bits. The strings are unpacked as
+ * they are sent, without a RAM buffer, and the script prints the bytes saved.
+ *
+ * Run the script with `--quick_reject` to also generate a bitset of the pairs
+ * of keys that typos end with, 98 bytes. Most keys end in a pair that no typo
+ * ends with, and for these the trie walk is skipped after a single PROGMEM
+ * read. The script prints the fraction of keys skipped. This has no effect with
+ * `--automaton`.
  *
  * Step 3: Finally, recompile and flash your keymap.
  *
+ * @note Add `SRC += features/keycode_classes.c` in rules.mk, which this uses
+ * to classify keycodes.
+ *
  * For full documentation, see
  * <https://getreuer.info/posts/keyboards/autocorrection>
  *
@@ -109,6 +145,128 @@ extern "C" {
  */
 bool process_autocorrection(uint16_t keycode, keyrecord_t* record);
 
+/**
+ * Dictionary layers
+ * -----------------
+ *
+ * Pass make_autocorrection_data.py a comma-separated list of dictionaries to
+ * merge them as layers into one trie, e.g. for prose and for code:
+ *
+ *     $ python3 make_autocorrection_data.py prose.txt,code.txt
+ *
+ * Layer i is enabled by bit `1 << i` of a runtime mask, here 1 for prose.txt
+ * and 2 for code.txt. Typos in several dictionaries are stored once, with a
+ * byte at their leaf with the mask of their layers, so the merged trie is
+ * smaller than the dictionaries built separately, and the script prints the
+ * difference. The mask is read only when a typo is found, so lookup costs the
+ * same as with a single dictionary. Up to 8 layers are supported, not with
+ * `--automaton` or AUTOCORRECTION_UPLOAD. A typo may be in several
+ * dictionaries only with the same correction.
+ *
+ * All layers are enabled at startup, or define AUTOCORRECTION_DEFAULT_LAYERS in
+ * config.h to the mask to start with. Change it at runtime, e.g. from a macro
+ * or on a layer change, like
+ *
+ *     autocorrection_set_layers(2);  // Only code.txt.
+ *
+ * Without layered dictionaries, the mask has no effect.
+ */
+void autocorrection_set_layers(uint8_t layers);
+
+/** Gets the mask of the enabled dictionary layers. */
+uint8_t autocorrection_get_layers(void);
+
+/**
+ * Uploading the dictionary at runtime
+ * -----------------------------------
+ *
+ * Define AUTOCORRECTION_UPLOAD in config.h to read the dictionary from EEPROM
+ * instead of autocorrection_data.h, so that it can be changed without
+ * reflashing. The dictionary is uploaded over raw HID (`RAW_ENABLE = yes` in
+ * rules.mk) with upload_autocorrection_dict.py, which compiles the dictionary
+ * like make_autocorrection_data.py and sends it:
+ *
+ *     $ python3 upload_autocorrection_dict.py autocorrection_dict.txt
+ *
+ * In keymap.c, pass raw HID reports starting with 'C' to
+ * `autocorrection_upload_raw_hid()` like
+ *
+ *     void raw_hid_receive(uint8_t* data, uint8_t length) {
+ *       if (data[0] == 'C') {
+ *         autocorrection_upload_raw_hid(data, length);
+ *         raw_hid_send(data, length);
+ *       }
+ *     }
+ *
+ * The dictionary is stored at AUTOCORRECTION_EEPROM_ADDR, by default the user
+ * datablock with EECONFIG_USER_DATA_SIZE bytes. With Achordion's
+ * ACHORDION_ADAPTIVE, the end of the datablock is left for its learned
+ * timeouts, and a build error reports if the two regions overlap. Define both
+ * AUTOCORRECTION_EEPROM_ADDR and AUTOCORRECTION_EEPROM_SIZE to use another
+ * region. The lookup walks the same trie as from PROGMEM, reading bytes from
+ * EEPROM. Define AUTOCORRECTION_BITMAP_NODES or AUTOCORRECTION_IDENTIFIERS to
+ * accept dictionaries with those options. Until a dictionary is uploaded,
+ * autocorrection is inactive. The automaton and packed strings, which save
+ * flash, are not supported.
+ *
+ * The stored format is an AUTOCORRECTION_HEADER_SIZE-byte header followed by
+ * the trie data, as in autocorrection_data.h:
+ *
+ *     Byte 0:    AUTOCORRECTION_FORMAT_VERSION.
+ *     Byte 1:    AUTOCORRECTION_FLAG_* flags of the format.
+ *     Byte 2-3:  Min and max typo length.
+ *     Byte 4-5:  Size of the trie data, little endian.
+ *     Byte 6-7:  CRC-16/CCITT-FALSE of the trie data, little endian.
+ *
+ * Each report is 32 bytes: data[0] = 'C', data[1] = an
+ * AUTOCORRECTION_UPLOAD_* command, and the reply has the status in data[2].
+ *
+ *     INFO:   Replies with the format version in data[3], supported flags in
+ *             data[4], EEPROM size in data[5-6], AUTOCORRECTION_MAX_LENGTH in
+ *             data[7], and the header of the dictionary in use, if any, in
+ *             data[8-15].
+ *     BEGIN:  Starts an upload of data[3-4] bytes, invalidating the stored
+ *             dictionary.
+ *     WRITE:  Writes the data[5] bytes at data[6] to offset data[3-4].
+ *     END:    Checks the header and CRC, and if valid, uses the dictionary.
+ *
+ * For testing without a keyboard, tools/autocorrection_sim builds a stand-in
+ * of the device on the host.
+ */
+#ifdef AUTOCORRECTION_UPLOAD
+#ifndef AUTOCORRECTION_MAX_LENGTH
+#define AUTOCORRECTION_MAX_LENGTH 16
+#endif  // AUTOCORRECTION_MAX_LENGTH
+
+#define AUTOCORRECTION_FORMAT_VERSION 1
+#define AUTOCORRECTION_HEADER_SIZE 8
+#define AUTOCORRECTION_FLAG_BITMAP_NODES 1
+#define AUTOCORRECTION_FLAG_IDENTIFIERS 2
+
+// Upload commands.
+enum {
+  AUTOCORRECTION_UPLOAD_INFO = 1,
+  AUTOCORRECTION_UPLOAD_BEGIN = 2,
+  AUTOCORRECTION_UPLOAD_WRITE = 3,
+  AUTOCORRECTION_UPLOAD_END = 4,
+};
+
+// Upload status codes.
+enum {
+  AUTOCORRECTION_UPLOAD_OK = 0,
+  AUTOCORRECTION_UPLOAD_BAD_COMMAND = 1,
+  // The upload exceeds the EEPROM region, or a write exceeds the upload.
+  AUTOCORRECTION_UPLOAD_BAD_SIZE = 2,
+  AUTOCORRECTION_UPLOAD_NOT_STARTED = 3,
+  // Unsupported version or flags, or typo lengths out of range.
+  AUTOCORRECTION_UPLOAD_BAD_HEADER = 4,
+  AUTOCORRECTION_UPLOAD_BAD_CRC = 5,
+};
+
+/** Handles an upload command in a raw HID report, writing the reply to it. */
+void autocorrection_upload_raw_hid(uint8_t* data, uint8_t length);
+#endif  // AUTOCORRECTION_UPLOAD
+
 #ifdef __cplusplus
 }
 #endif
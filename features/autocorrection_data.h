@@ -90,79 +90,62 @@
 #define AUTOCORRECTION_MIN_LENGTH 5  // ":ture"
 #define AUTOCORRECTION_MAX_LENGTH 10  // "accomodate"
 
-static const uint8_t autocorrection_data[1120] PROGMEM = {
-    108, 43,  0,   6,   71,  0,   7,   81,  0,   8,   199, 0,   9,   240, 1,
-    10,  250, 1,   11,  26,  2,   17,  53,  2,   18,  190, 2,   19,  202, 2,
-    21,  212, 2,   22,  20,  3,   23,  67,  3,   28,  32,  4,   0,   72,  50,
-    0,   22,  60,  0,   0,   11,  23,  44,  8,   11,  23,  44,  0,   132, 0,
-    8,   22,  18,  18,  15,  0,   132, 115, 101, 115, 0,   11,  23,  12,  26,
-    22,  0,   129, 99,  104, 0,   68,  94,  0,   8,   106, 0,   15,  174, 0,
-    21,  187, 0,   0,   12,  15,  25,  17,  12,  0,   131, 97,  108, 105, 100,
-    0,   74,  119, 0,   12,  129, 0,   21,  140, 0,   24,  165, 0,   0,   17,
-    12,  22,  0,   131, 103, 110, 101, 100, 0,   25,  21,  8,   7,   0,   131,
-    105, 118, 101, 100, 0,   72,  147, 0,   24,  156, 0,   0,   9,   8,   21,
-    0,   129, 114, 101, 100, 0,   6,   6,   18,  0,   129, 114, 101, 100, 0,
-    15,  6,   17,  12,  0,   129, 100, 101, 0,   18,  22,  8,   21,  11,  23,
-    0,   130, 104, 111, 108, 100, 0,   4,   26,  18,  9,   0,   131, 114, 119,
-    97,  114, 100, 0,   68,  233, 0,   6,   246, 0,   7,   4,   1,   8,   16,
-    1,   10,  52,  1,   15,  81,  1,   21,  90,  1,   22,  117, 1,   23,  144,
-    1,   24,  215, 1,   25,  228, 1,   0,   6,   19,  22,  8,   16,  4,   17,
-    0,   130, 97,  99,  101, 0,   19,  4,   22,  8,   16,  4,   17,  0,   131,
-    112, 97,  99,  101, 0,   12,  21,  8,   25,  18,  0,   130, 114, 105, 100,
-    101, 0,   23,  0,   68,  25,  1,   17,  36,  1,   0,   21,  4,   24,  10,
-    0,   130, 110, 116, 101, 101, 0,   4,   21,  24,  4,   10,  0,   135, 117,
-    97,  114, 97,  110, 116, 101, 101, 0,   68,  59,  1,   7,   69,  1,   0,
-    24,  10,  44,  0,   131, 97,  117, 103, 101, 0,   8,   15,  12,  25,  12,
-    21,  19,  0,   130, 103, 101, 0,   22,  4,   9,   0,   130, 108, 115, 101,
-    0,   76,  97,  1,   24,  109, 1,   0,   24,  20,  4,   0,   132, 99,  113,
-    117, 105, 114, 101, 0,   23,  44,  0,   130, 114, 117, 101, 0,   4,   0,
-    79,  126, 1,   24,  134, 1,   0,   9,   0,   131, 97,  108, 115, 101, 0,
-    6,   8,   5,   0,   131, 97,  117, 115, 101, 0,   4,   0,   71,  156, 1,
-    19,  193, 1,   21,  203, 1,   0,   18,  16,  0,   80,  166, 1,   18,  181,
-    1,   0,   18,  6,   4,   0,   135, 99,  111, 109, 109, 111, 100, 97,  116,
-    101, 0,   6,   6,   4,   0,   132, 109, 111, 100, 97,  116, 101, 0,   7,
-    24,  0,   132, 112, 100, 97,  116, 101, 0,   8,   19,  8,   22,  0,   132,
-    97,  114, 97,  116, 101, 0,   10,  8,   15,  15,  18,  6,   0,   130, 97,
-    103, 117, 101, 0,   8,   12,  6,   8,   21,  0,   131, 101, 105, 118, 101,
-    0,   12,  8,   11,  6,   0,   130, 105, 101, 102, 0,   17,  0,   76,  3,
-    2,   21,  16,  2,   0,   15,  8,   12,  6,   0,   133, 101, 105, 108, 105,
-    110, 103, 0,   12,  23,  22,  0,   131, 114, 105, 110, 103, 0,   70,  33,
-    2,   23,  44,  2,   0,   12,  23,  26,  22,  0,   131, 105, 116, 99,  104,
-    0,   10,  12,  8,   11,  0,   129, 104, 116, 0,   72,  69,  2,   10,  80,
-    2,   18,  89,  2,   21,  156, 2,   24,  167, 2,   0,   22,  18,  18,  11,
-    6,   0,   131, 115, 101, 110, 0,   12,  21,  23,  22,  0,   129, 110, 103,
-    0,   12,  0,   86,  98,  2,   23,  124, 2,   0,   68,  105, 2,   22,  114,
-    2,   0,   12,  15,  0,   131, 105, 115, 111, 110, 0,   4,   6,   6,   18,
-    0,   131, 105, 111, 110, 0,   76,  131, 2,   22,  146, 2,   0,   23,  12,
-    19,  8,   21,  0,   134, 101, 116, 105, 116, 105, 111, 110, 0,   18,  19,
-    0,   131, 105, 116, 105, 111, 110, 0,   23,  24,  8,   21,  0,   131, 116,
-    117, 114, 110, 0,   85,  174, 2,   23,  183, 2,   0,   23,  8,   21,  0,
-    130, 117, 114, 110, 0,   8,   21,  0,   128, 114, 110, 0,   7,   8,   24,
-    22,  19,  0,   131, 101, 117, 100, 111, 0,   24,  18,  18,  15,  0,   129,
-    107, 117, 112, 0,   72,  219, 2,   18,  3,   3,   0,   76,  229, 2,   15,
-    238, 2,   17,  248, 2,   0,   11,  23,  44,  0,   130, 101, 105, 114, 0,
-    23,  12,  9,   0,   131, 108, 116, 101, 114, 0,   23,  22,  12,  15,  0,
-    130, 101, 110, 101, 114, 0,   23,  4,   21,  8,   23,  17,  12,  0,   135,
-    116, 101, 114, 97,  116, 111, 114, 0,   72,  30,  3,   17,  38,  3,   24,
-    51,  3,   0,   15,  4,   9,   0,   129, 115, 101, 0,   4,   12,  23,  17,
-    18,  6,   0,   131, 97,  105, 110, 115, 0,   22,  17,  8,   6,   17,  18,
-    6,   0,   133, 115, 101, 110, 115, 117, 115, 0,   116, 89,  3,   10,  102,
-    3,   11,  112, 3,   15,  134, 3,   17,  145, 3,   22,  234, 3,   24,  248,
-    3,   0,   17,  8,   22,  18,  7,   0,   132, 101, 115, 110, 39,  116, 0,
-    11,  24,  4,   6,   0,   130, 103, 104, 116, 0,   71,  119, 3,   10,  126,
-    3,   0,   12,  26,  0,   129, 116, 104, 0,   17,  8,   15,  0,   129, 116,
-    104, 0,   22,  24,  8,   21,  0,   131, 115, 117, 108, 116, 0,   68,  155,
-    3,   8,   166, 3,   22,  226, 3,   0,   21,  4,   19,  19,  4,   0,   130,
-    101, 110, 116, 0,   85,  173, 3,   25,  216, 3,   0,   68,  180, 3,   21,
-    191, 3,   0,   19,  4,   0,   132, 112, 97,  114, 101, 110, 116, 0,   4,
-    19,  0,   68,  201, 3,   19,  209, 3,   0,   133, 112, 97,  114, 101, 110,
-    116, 0,   4,   0,   131, 101, 110, 116, 0,   8,   15,  8,   21,  0,   130,
-    97,  110, 116, 0,   18,  6,   0,   130, 110, 115, 116, 0,   12,  9,   8,
-    17,  4,   16,  0,   132, 105, 102, 101, 115, 116, 0,   83,  255, 3,   23,
-    22,  4,   0,   87,  6,   4,   24,  14,  4,   0,   17,  12,  0,   131, 112,
-    117, 116, 0,   18,  0,   130, 116, 112, 117, 116, 0,   19,  24,  18,  0,
-    131, 116, 112, 117, 116, 0,   70,  45,  4,   8,   57,  4,   11,  67,  4,
-    21,  85,  4,   0,   8,   24,  20,  8,   21,  9,   0,   129, 110, 99,  121,
-    0,   23,  9,   4,   22,  0,   130, 101, 116, 121, 0,   6,   21,  4,   21,
-    12,  8,   11,  0,   135, 105, 101, 114, 97,  114, 99,  104, 121, 0,   4,
-    5,   12,  15,  0,   130, 114, 97,  114, 121, 0};
+static const uint8_t autocorrection_data[1107] PROGMEM = {108, 43, 0, 6, 71, 0,
+  7, 81, 0, 8, 197, 0, 9, 238, 1, 10, 248, 1, 11, 24, 2, 17, 51, 2, 18, 188, 2,
+  19, 200, 2, 21, 210, 2, 22, 18, 3, 23, 65, 3, 28, 7, 4, 0, 72, 50, 0, 22, 60,
+  0, 0, 11, 23, 44, 8, 11, 23, 44, 0, 132, 0, 8, 22, 18, 18, 15, 0, 132, 115,
+  101, 115, 0, 11, 23, 12, 26, 22, 0, 129, 99, 104, 0, 68, 94, 0, 8, 106, 0, 15,
+  172, 0, 21, 185, 0, 0, 12, 15, 25, 17, 12, 0, 131, 97, 108, 105, 100, 0, 74,
+  119, 0, 12, 129, 0, 21, 140, 0, 24, 163, 0, 0, 17, 12, 22, 0, 131, 103, 110,
+  101, 100, 0, 25, 21, 8, 7, 0, 131, 105, 118, 101, 100, 0, 72, 147, 0, 24, 156,
+  0, 0, 9, 8, 21, 0, 129, 114, 101, 100, 0, 6, 6, 0, 82, 151, 0, 0, 15, 6, 17,
+  12, 0, 129, 100, 101, 0, 18, 22, 8, 21, 11, 23, 0, 130, 104, 111, 108, 100, 0,
+  4, 26, 18, 9, 0, 131, 114, 119, 97, 114, 100, 0, 68, 231, 0, 6, 244, 0, 7, 2,
+  1, 8, 14, 1, 10, 50, 1, 15, 79, 1, 21, 88, 1, 22, 115, 1, 23, 142, 1, 24, 213,
+  1, 25, 226, 1, 0, 6, 19, 22, 8, 16, 4, 17, 0, 130, 97, 99, 101, 0, 19, 4, 22,
+  8, 16, 4, 17, 0, 131, 112, 97, 99, 101, 0, 12, 21, 8, 25, 18, 0, 130, 114,
+  105, 100, 101, 0, 23, 0, 68, 23, 1, 17, 34, 1, 0, 21, 4, 24, 10, 0, 130, 110,
+  116, 101, 101, 0, 4, 21, 24, 4, 10, 0, 135, 117, 97, 114, 97, 110, 116, 101,
+  101, 0, 68, 57, 1, 7, 67, 1, 0, 24, 10, 44, 0, 131, 97, 117, 103, 101, 0, 8,
+  15, 12, 25, 12, 21, 19, 0, 130, 103, 101, 0, 22, 4, 9, 0, 130, 108, 115, 101,
+  0, 76, 95, 1, 24, 107, 1, 0, 24, 20, 4, 0, 132, 99, 113, 117, 105, 114, 101,
+  0, 23, 44, 0, 130, 114, 117, 101, 0, 4, 0, 79, 124, 1, 24, 132, 1, 0, 9, 0,
+  131, 97, 108, 115, 101, 0, 6, 8, 5, 0, 131, 97, 117, 115, 101, 0, 4, 0, 71,
+  154, 1, 19, 191, 1, 21, 201, 1, 0, 18, 16, 0, 80, 164, 1, 18, 179, 1, 0, 18,
+  6, 4, 0, 135, 99, 111, 109, 109, 111, 100, 97, 116, 101, 0, 6, 6, 4, 0, 132,
+  109, 111, 100, 97, 116, 101, 0, 7, 24, 0, 132, 112, 100, 97, 116, 101, 0, 8,
+  19, 8, 22, 0, 132, 97, 114, 97, 116, 101, 0, 10, 8, 15, 15, 18, 6, 0, 130, 97,
+  103, 117, 101, 0, 8, 12, 6, 8, 21, 0, 131, 101, 105, 118, 101, 0, 12, 8, 11,
+  6, 0, 130, 105, 101, 102, 0, 17, 0, 76, 1, 2, 21, 14, 2, 0, 15, 8, 12, 6, 0,
+  133, 101, 105, 108, 105, 110, 103, 0, 12, 23, 22, 0, 131, 114, 105, 110, 103,
+  0, 70, 31, 2, 23, 42, 2, 0, 12, 23, 26, 22, 0, 131, 105, 116, 99, 104, 0, 10,
+  12, 8, 11, 0, 129, 104, 116, 0, 72, 67, 2, 10, 78, 2, 18, 87, 2, 21, 154, 2,
+  24, 165, 2, 0, 22, 18, 18, 11, 6, 0, 131, 115, 101, 110, 0, 12, 21, 23, 22, 0,
+  129, 110, 103, 0, 12, 0, 86, 96, 2, 23, 122, 2, 0, 68, 103, 2, 22, 112, 2, 0,
+  12, 15, 0, 131, 105, 115, 111, 110, 0, 4, 6, 6, 18, 0, 131, 105, 111, 110, 0,
+  76, 129, 2, 22, 144, 2, 0, 23, 12, 19, 8, 21, 0, 134, 101, 116, 105, 116, 105,
+  111, 110, 0, 18, 19, 0, 131, 105, 116, 105, 111, 110, 0, 23, 24, 8, 21, 0,
+  131, 116, 117, 114, 110, 0, 85, 172, 2, 23, 181, 2, 0, 23, 8, 21, 0, 130, 117,
+  114, 110, 0, 8, 21, 0, 128, 114, 110, 0, 7, 8, 24, 22, 19, 0, 131, 101, 117,
+  100, 111, 0, 24, 18, 18, 15, 0, 129, 107, 117, 112, 0, 72, 217, 2, 18, 1, 3,
+  0, 76, 227, 2, 15, 236, 2, 17, 246, 2, 0, 11, 23, 44, 0, 130, 101, 105, 114,
+  0, 23, 12, 9, 0, 131, 108, 116, 101, 114, 0, 23, 22, 12, 15, 0, 130, 101, 110,
+  101, 114, 0, 23, 4, 21, 8, 23, 17, 12, 0, 135, 116, 101, 114, 97, 116, 111,
+  114, 0, 72, 28, 3, 17, 36, 3, 24, 49, 3, 0, 15, 4, 9, 0, 129, 115, 101, 0, 4,
+  12, 23, 17, 18, 6, 0, 131, 97, 105, 110, 115, 0, 22, 17, 8, 6, 17, 18, 6, 0,
+  133, 115, 101, 110, 115, 117, 115, 0, 116, 87, 3, 10, 100, 3, 11, 110, 3, 15,
+  131, 3, 17, 142, 3, 22, 217, 3, 24, 231, 3, 0, 17, 8, 22, 18, 7, 0, 132, 101,
+  115, 110, 39, 116, 0, 11, 24, 4, 6, 0, 130, 103, 104, 116, 0, 71, 117, 3, 10,
+  124, 3, 0, 12, 26, 0, 129, 116, 104, 0, 17, 8, 0, 79, 120, 3, 0, 22, 24, 8,
+  21, 0, 131, 115, 117, 108, 116, 0, 68, 152, 3, 8, 161, 3, 22, 209, 3, 0, 21,
+  4, 19, 19, 4, 0, 194, 74, 4, 85, 168, 3, 25, 199, 3, 0, 68, 175, 3, 21, 181,
+  3, 0, 19, 4, 0, 196, 71, 4, 4, 19, 0, 68, 191, 3, 19, 194, 3, 0, 197, 71, 4,
+  4, 0, 195, 74, 4, 8, 15, 8, 21, 0, 130, 97, 110, 116, 0, 18, 6, 0, 130, 110,
+  115, 116, 0, 12, 9, 8, 17, 4, 16, 0, 132, 105, 102, 101, 115, 116, 0, 83, 238,
+  3, 23, 0, 4, 0, 87, 245, 3, 24, 251, 3, 0, 17, 12, 0, 195, 79, 4, 18, 0, 194,
+  78, 4, 19, 24, 18, 0, 195, 78, 4, 70, 20, 4, 8, 32, 4, 11, 42, 4, 21, 60, 4,
+  0, 8, 24, 20, 8, 21, 9, 0, 129, 110, 99, 121, 0, 23, 9, 4, 22, 0, 130, 101,
+  116, 121, 0, 6, 21, 4, 21, 12, 8, 11, 0, 135, 105, 101, 114, 97, 114, 99, 104,
+  121, 0, 4, 5, 12, 15, 0, 130, 114, 97, 114, 121, 0, 112, 97, 114, 101, 110,
+  116, 0, 116, 112, 117, 116, 0};
+
@@ -22,6 +22,8 @@
 
 #include "caps_word.h"
 
+#include "keycode_classes.h"
+
 #pragma message \
     "Caps Word is now a core QMK feature! To use it, update your QMK set up and see https://docs.qmk.fm/features/caps_word"
 
@@ -211,7 +213,8 @@ bool process_caps_word(uint16_t keycode, keyrecord_t* record) {
         set_weak_mods(get_weak_mods() ^ MOD_BIT(KC_LSFT));
       }
 #endif  // CAPS_WORD_INVERT_ON_SHIFT
-      send_keyboard_report();
+      // The weak mods are sent with the key's own report, so no report is
+      // sent here.
       return true;
     }
   }
@@ -263,22 +266,15 @@ bool is_caps_word_on(void) { return caps_word_active; }
 __attribute__((weak)) void caps_word_set_user(bool active) {}
 
 __attribute__((weak)) bool caps_word_press_user(uint16_t keycode) {
-  switch (keycode) {
-    // Keycodes that continue Caps Word, with shift applied.
-    case KC_A ... KC_Z:
-    case KC_MINS:
-      add_weak_mods(MOD_BIT(KC_LSFT));  // Apply shift to the next key.
-      return true;
-
-    // Keycodes that continue Caps Word, without shifting.
-    case KC_1 ... KC_0:
-    case KC_BSPC:
-    case KC_DEL:
-    case KC_UNDS:
-      return true;
-
-    default:
-      return false;  // Deactivate Caps Word.
+  const uint8_t classes = keycode_classes(keycode);
+  // Keycodes that continue Caps Word, with shift applied.
+  if (classes & KEYCODE_CLASS_SHIFTABLE) {
+    add_weak_mods(MOD_BIT(KC_LSFT));  // Apply shift to the next key.
+    return true;
   }
+
+  // Keycodes that continue Caps Word, without shifting. Otherwise deactivate.
+  return (classes & KEYCODE_CLASS_DIGIT) || keycode == KC_BSPC ||
+         keycode == KC_DEL || keycode == KC_UNDS;
 }
 #endif  // version check
@@ -60,6 +60,9 @@
  *       // Other tasks...
  *     }
  *
+ * @note Add `SRC += features/keycode_classes.c` in rules.mk, which this uses
+ * to classify keycodes.
+ *
  * For full documentation, see
  * <https://getreuer.info/posts/keyboards/caps-word>
  */
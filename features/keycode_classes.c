@@ -0,0 +1,28 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file keycode_classes.c
+ * @brief Keycode classes implementation
+ */
+
+#include "keycode_classes.h"
+
+#include "keycode_classes_data.h"
+
+uint8_t keycode_classes(uint16_t keycode) {
+  return (keycode < KEYCODE_CLASS_TABLE_SIZE)
+             ? pgm_read_byte(keycode_class_table + keycode)
+             : 0;
+}
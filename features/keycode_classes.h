@@ -0,0 +1,84 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file keycode_classes.h
+ * @brief Keycode classes shared by the text features
+ *
+ * Overview
+ * --------
+ *
+ * Caps Word, Sentence Case, Autocorrection, and Achordion each decide what a
+ * key does to the text: whether it is a letter, ends a sentence, breaks a
+ * word, and so on. This library answers these questions for all of
+ * them from one PROGMEM table of class bits per basic keycode, so that a
+ * keycode is classified with a single read rather than a switch in each
+ * feature.
+ *
+ * The table is generated by make_keycode_classes.py into
+ * keycode_classes_data.h. To change which keycodes are in a class, edit the
+ * classes in the script and rerun it.
+ *
+ *
+ * Add it to your keymap
+ * ---------------------
+ *
+ * In rules.mk, add `SRC += features/keycode_classes.c` along with any of the
+ * features above, or with this userspace's rules.mk, set
+ * `KEYCODE_CLASSES_ENABLE = yes`, which Achordion and Sentence Case do
+ * already. The features use it internally, and it can be used in keymap.c too,
+ * like
+ *
+ *     #include "features/keycode_classes.h"
+ *
+ *     if (keycode_classes(keycode) & KEYCODE_CLASS_LETTER) {
+ *       // Letter key...
+ *     }
+ */
+
+#pragma once
+
+#include "quantum.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Keycode class bits, as generated by make_keycode_classes.py. */
+enum {
+  /** KC_A to KC_Z. */
+  KEYCODE_CLASS_LETTER = 1,
+  /** KC_1 to KC_0. */
+  KEYCODE_CLASS_DIGIT = 2,
+  /** Punctuation and symbol keys, KC_MINS to KC_SLSH. */
+  KEYCODE_CLASS_SYMBOL = 4,
+  /** Ends a sentence when unshifted: KC_DOT. */
+  KEYCODE_CLASS_SENTENCE_END = 8,
+  /** Ends a sentence when shifted: KC_1 and KC_SLSH, typing ! and ?. */
+  KEYCODE_CLASS_SENTENCE_END_SHIFTED = 16,
+  /** Breaks a word: digits, symbols, enter, tab, and space. */
+  KEYCODE_CLASS_WORD_BREAK = 32,
+  /** Shifted by Caps Word: letters and KC_MINS. */
+  KEYCODE_CLASS_SHIFTABLE = 64,
+};
+
+/**
+ * Gets the KEYCODE_CLASS_* bits of `keycode`, or 0 if it is not a basic
+ * keycode in any class. Tap-hold and shifted keycodes are not unwrapped.
+ */
+uint8_t keycode_classes(uint16_t keycode);
+
+#ifdef __cplusplus
+}
+#endif
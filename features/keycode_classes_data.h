@@ -0,0 +1,72 @@
+// Generated code.
+
+// Keycode classes:
+//     1  KEYCODE_CLASS_LETTER
+//     2  KEYCODE_CLASS_DIGIT
+//     4  KEYCODE_CLASS_SYMBOL
+//     8  KEYCODE_CLASS_SENTENCE_END
+//    16  KEYCODE_CLASS_SENTENCE_END_SHIFTED
+//    32  KEYCODE_CLASS_WORD_BREAK
+//    64  KEYCODE_CLASS_SHIFTABLE
+
+#define KEYCODE_CLASS_TABLE_SIZE 57
+
+static const uint8_t keycode_class_table[KEYCODE_CLASS_TABLE_SIZE] PROGMEM = {
+    0,  // KC_NO
+    0,  // KC_TRNS
+    0,  // 0x2
+    0,  // 0x3
+   65,  // KC_A    LETTER SHIFTABLE
+   65,  // KC_B    LETTER SHIFTABLE
+   65,  // KC_C    LETTER SHIFTABLE
+   65,  // KC_D    LETTER SHIFTABLE
+   65,  // KC_E    LETTER SHIFTABLE
+   65,  // KC_F    LETTER SHIFTABLE
+   65,  // KC_G    LETTER SHIFTABLE
+   65,  // KC_H    LETTER SHIFTABLE
+   65,  // KC_I    LETTER SHIFTABLE
+   65,  // KC_J    LETTER SHIFTABLE
+   65,  // KC_K    LETTER SHIFTABLE
+   65,  // KC_L    LETTER SHIFTABLE
+   65,  // KC_M    LETTER SHIFTABLE
+   65,  // KC_N    LETTER SHIFTABLE
+   65,  // KC_O    LETTER SHIFTABLE
+   65,  // KC_P    LETTER SHIFTABLE
+   65,  // KC_Q    LETTER SHIFTABLE
+   65,  // KC_R    LETTER SHIFTABLE
+   65,  // KC_S    LETTER SHIFTABLE
+   65,  // KC_T    LETTER SHIFTABLE
+   65,  // KC_U    LETTER SHIFTABLE
+   65,  // KC_V    LETTER SHIFTABLE
+   65,  // KC_W    LETTER SHIFTABLE
+   65,  // KC_X    LETTER SHIFTABLE
+   65,  // KC_Y    LETTER SHIFTABLE
+   65,  // KC_Z    LETTER SHIFTABLE
+   50,  // KC_1    DIGIT SENTENCE_END_SHIFTED WORD_BREAK
+   34,  // KC_2    DIGIT WORD_BREAK
+   34,  // KC_3    DIGIT WORD_BREAK
+   34,  // KC_4    DIGIT WORD_BREAK
+   34,  // KC_5    DIGIT WORD_BREAK
+   34,  // KC_6    DIGIT WORD_BREAK
+   34,  // KC_7    DIGIT WORD_BREAK
+   34,  // KC_8    DIGIT WORD_BREAK
+   34,  // KC_9    DIGIT WORD_BREAK
+   34,  // KC_0    DIGIT WORD_BREAK
+   32,  // KC_ENT  WORD_BREAK
+    0,  // KC_ESC
+    0,  // KC_BSPC
+   32,  // KC_TAB  WORD_BREAK
+   32,  // KC_SPC  WORD_BREAK
+  100,  // KC_MINS SYMBOL WORD_BREAK SHIFTABLE
+   36,  // KC_EQL  SYMBOL WORD_BREAK
+   36,  // KC_LBRC SYMBOL WORD_BREAK
+   36,  // KC_RBRC SYMBOL WORD_BREAK
+   36,  // KC_BSLS SYMBOL WORD_BREAK
+   36,  // KC_NUHS SYMBOL WORD_BREAK
+   36,  // KC_SCLN SYMBOL WORD_BREAK
+   36,  // KC_QUOT SYMBOL WORD_BREAK
+   36,  // KC_GRV  SYMBOL WORD_BREAK
+   36,  // KC_COMM SYMBOL WORD_BREAK
+   44,  // KC_DOT  SYMBOL SENTENCE_END WORD_BREAK
+   52,  // KC_SLSH SYMBOL SENTENCE_END_SHIFTED WORD_BREAK
+};
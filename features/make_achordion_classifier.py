@@ -0,0 +1,279 @@
+# Copyright 2024 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Python program to make achordion_classifier.h.
+
+This program trains the classifier that Achordion uses in place of
+`achordion_chord()` when ACHORDION_CLASSIFIER is defined. It reads keystroke
+logs, extracts a decision for each tap-hold key press that is followed by
+another key press while it is held, and fits a logistic regression model of
+whether the tap-hold key was intended as held. The weights are quantized to
+fixed point and written as a C header. Run this program like
+
+$ python3 make_achordion_classifier.py a.log b.log
+
+The logs have the format of tools/achordion_sim/replay.c, one key event
+"<time ms> <row> <col> <d|u> [tap|hold]" per line, where presses of tap-hold
+keys are marked with the intended outcome. Every press of a tap-hold key should
+be marked: as in replay.c, the positions marked anywhere in the logs are taken
+to be the tap-hold keys, which at runtime are the keys with mod-tap or
+layer-tap keycodes. Options:
+
+  --rows=N   Number of matrix rows (default 12). Rows below N/2 are the left
+             hand, as for a split keyboard.
+  --out=F    Output file (default "achordion_classifier.h").
+
+For full documentation, see
+https://getreuer.info/posts/keyboards/achordion
+"""
+
+import collections
+import math
+import sys
+import textwrap
+from typing import List, Optional, Sequence, Set, Tuple
+
+# Features, in the order used by classify_chord() in achordion.c.
+FEATURE_NAMES = ('gap', 'idle', 'overlap', 'opposite_hands', 'same_row',
+                 'other_tap_hold')
+# Scale of each feature for training, so that all are of order 1.
+FEATURE_SCALES = (255.0, 255.0, 255.0, 1.0, 1.0, 1.0)
+# Ridge regularization strength.
+RIDGE = 1e-3
+
+Event = collections.namedtuple('Event',
+                               ['time', 'row', 'col', 'pressed', 'intent'])
+Position = Tuple[int, int]
+
+
+def parse_log(file_name: str) -> List[Event]:
+  """Parses a keystroke log into a list of events."""
+  events = []
+  for line_number, line in enumerate(open(file_name, 'rt'), 1):
+    tokens = line.split()
+    if not tokens or tokens[0].startswith('#'):
+      continue
+    elif len(tokens) < 4 or tokens[3] not in ('d', 'u'):
+      print(f'Error:{file_name}:{line_number}: Invalid event: "{line.strip()}"')
+      sys.exit(1)
+    intent = tokens[4] if len(tokens) > 4 else None
+    events.append(Event(int(tokens[0]), int(tokens[1]), int(tokens[2]),
+                        tokens[3] == 'd', intent))
+
+  return sorted(events, key=lambda e: e.time)
+
+
+def find_tap_hold_positions(
+    logs: Sequence[Sequence[Event]]) -> Set[Position]:
+  """Finds the tap-hold keys, those whose presses are marked in any log."""
+  positions = {(e.row, e.col) for events in logs for e in events
+               if e.pressed and e.intent}
+  unmarked = sorted({(e.row, e.col) for events in logs for e in events
+                     if e.pressed and not e.intent} & positions)
+  if unmarked:
+    print('Warning: Some presses of tap-hold keys are not marked with an '
+          'intent, at (row, col): ' + ', '.join(map(str, unmarked)))
+  return positions
+
+
+def extract_samples(events: Sequence[Event], rows: int,
+                    tap_hold_positions: Set[Position]
+                    ) -> List[Tuple[List[int], int]]:
+  """Extracts (features, is_hold) for each decision in the events.
+
+  The other_tap_hold feature is whether the next key is in
+  `tap_hold_positions`, matching classify_chord() in achordion.c, which checks
+  whether its keycode is a mod-tap or layer-tap.
+  """
+  # For each press, the time of the corresponding release.
+  release_time = {}
+  held = {}
+  for i, e in enumerate(events):
+    pos = (e.row, e.col)
+    if e.pressed:
+      held[pos] = i
+    elif pos in held:
+      release_time[held.pop(pos)] = e.time
+
+  presses = [i for i, e in enumerate(events) if e.pressed]
+  samples = []
+  for n, i in enumerate(presses):
+    p = events[i]
+    if p.intent not in ('tap', 'hold') or n + 1 >= len(presses):
+      continue
+    q = events[presses[n + 1]]  # The next key press.
+    if q.time >= release_time.get(i, math.inf):
+      continue  # Released before the next press, not decided by a chord.
+
+    gap = min(q.time - p.time, 255)
+    idle, overlap = 255, 0
+    if n > 0:
+      k = presses[n - 1]
+      idle = min(p.time - events[k].time, 255)
+      prev_release = release_time.get(k, math.inf)
+      if prev_release > p.time:
+        overlap = min(min(prev_release, q.time) - p.time, 255)
+
+    features = [gap, idle, overlap,
+                int((p.row < rows // 2) != (q.row < rows // 2)),
+                int(p.row == q.row),
+                int((q.row, q.col) in tap_hold_positions)]
+    samples.append((features, int(p.intent == 'hold')))
+
+  return samples
+
+
+def solve(a: List[List[float]], b: List[float]) -> List[float]:
+  """Solves the linear system a x = b by Gaussian elimination."""
+  n = len(b)
+  m = [row[:] + [b[i]] for i, row in enumerate(a)]
+  for c in range(n):
+    pivot = max(range(c, n), key=lambda r: abs(m[r][c]))
+    m[c], m[pivot] = m[pivot], m[c]
+    for r in range(c + 1, n):
+      f = m[r][c] / m[c][c]
+      for k in range(c, n + 1):
+        m[r][k] -= f * m[c][k]
+  x = [0.0] * n
+  for r in reversed(range(n)):
+    x[r] = (m[r][n] - sum(m[r][k] * x[k] for k in range(r + 1, n))) / m[r][r]
+  return x
+
+
+def train(samples: List[Tuple[List[int], int]]) -> List[float]:
+  """Fits logistic regression by iteratively reweighted least squares.
+
+  Returns:
+    Weights for the bias and each feature, in units of the raw features.
+  """
+  xs = [[1.0] + [f / s for f, s in zip(features, FEATURE_SCALES)]
+        for features, _ in samples]
+  ys = [label for _, label in samples]
+  d = len(xs[0])
+  w = [0.0] * d
+
+  for _ in range(25):
+    # Newton step: (X^T W X + ridge) dw = X^T (y - p).
+    hessian = [[RIDGE * (i == j) for j in range(d)] for i in range(d)]
+    gradient = [-RIDGE * wi for wi in w]
+    for x, y in zip(xs, ys):
+      z = sum(wi * xi for wi, xi in zip(w, x))
+      p = 1.0 / (1.0 + math.exp(-max(min(z, 30.0), -30.0)))
+      v = max(p * (1.0 - p), 1e-6)
+      for i in range(d):
+        gradient[i] += (y - p) * x[i]
+        for j in range(d):
+          hessian[i][j] += v * x[i] * x[j]
+    step = solve(hessian, gradient)
+    w = [wi + si for wi, si in zip(w, step)]
+    if max(abs(si) for si in step) < 1e-6:
+      break
+
+  return [w[0]] + [wi / s for wi, s in zip(w[1:], FEATURE_SCALES)]
+
+
+def quantize(weights: List[float]) -> Tuple[int, List[int]]:
+  """Quantizes weights to an int32 bias and int16 feature weights."""
+  largest = max(abs(w) for w in weights[1:]) or 1.0
+  scale = 2.0 ** math.floor(math.log2(32767 / largest))
+  scale = min(scale, 2.0 ** 20)
+  bias = round(weights[0] * scale)
+  return max(min(bias, 2**31 - 1), -2**31), [round(w * scale)
+                                             for w in weights[1:]]
+
+
+def accuracy(samples: List[Tuple[List[int], int]], bias: float,
+             weights: Sequence[float]) -> float:
+  correct = sum(
+      (bias + sum(w * f for w, f in zip(weights, features)) > 0) == label
+      for features, label in samples)
+  return 100.0 * correct / len(samples)
+
+
+def write_generated_code(samples: List[Tuple[List[int], int]],
+                         log_files: List[str], bias: int, weights: List[int],
+                         file_name: str) -> None:
+  """Writes the quantized classifier as generated C code to `file_name`."""
+  holds = sum(label for _, label in samples)
+  fixed_accuracy = accuracy(samples, bias, weights)
+  rule_accuracy = accuracy(samples, -0.5, [0, 0, 0, 1, 0, 0])
+  generated_code = ''.join([
+    '// Generated code.\n\n',
+    f'// Achordion chord classifier trained on {len(samples)} decisions '
+    f'({holds} holds) from:\n',
+    ''.join(f'//   {name}\n' for name in log_files),
+    f'// Accuracy on these decisions: {fixed_accuracy:.2f}% '
+    f'(opposite hands rule: {rule_accuracy:.2f}%).\n',
+    '//\n',
+    '// A tap-hold key and the next key form a chord when\n',
+    '// BIAS + sum(weight * feature) > 0, where times are in ms saturated to '
+    '255:\n',
+    ''.join(f'//   {name:<15} {w:7}\n'
+            for name, w in zip(FEATURE_NAMES, weights)),
+    f'//\n// Cost: {2 * len(weights)} bytes of weights, and '
+    f'{len(weights)} multiply-adds of int16 by uint8\n',
+    '// into int32 per decision.\n',
+    f'\n#define ACHORDION_CLASSIFIER_NUM_FEATURES {len(weights)}\n',
+    f'#define ACHORDION_CLASSIFIER_BIAS ((int32_t){bias})\n\n',
+    textwrap.fill(
+        'static const int16_t achordion_classifier_weights[%d] PROGMEM = {%s};'
+        % (len(weights), ', '.join(map(str, weights))),
+        width=80, subsequent_indent='  '),
+    '\n\n'])
+
+  with open(file_name, 'wt') as f:
+    f.write(generated_code)
+
+
+def main(argv):
+  rows = 12
+  h_file = 'achordion_classifier.h'
+  log_files = []
+
+  for arg in argv[1:]:
+    if arg.startswith('--'):  # Parse command line options.
+      option, value = arg.split('=', 1)
+      if option == '--rows':
+        rows = int(value)
+      elif option == '--out':
+        h_file = value
+      else:
+        print(f'Invalid option: {arg}')
+        sys.exit(1)
+    else:
+      log_files.append(arg)
+
+  if not log_files:
+    print(__doc__)
+    sys.exit(1)
+
+  logs = [parse_log(log_file) for log_file in log_files]
+  tap_hold_positions = find_tap_hold_positions(logs)
+  samples = []
+  for events in logs:
+    samples += extract_samples(events, rows, tap_hold_positions)
+  if not samples or all(label == samples[0][1] for _, label in samples):
+    print('Error: The logs need decisions intended as both tap and hold.')
+    sys.exit(1)
+
+  weights = train(samples)
+  bias, fixed_weights = quantize(weights)
+  print(f'Trained on {len(samples)} decisions, accuracy '
+        f'{accuracy(samples, weights[0], weights[1:]):.2f}% '
+        f'({accuracy(samples, bias, fixed_weights):.2f}% in fixed point).')
+  write_generated_code(samples, log_files, bias, fixed_weights, h_file)
+
+
+if __name__ == '__main__':
+  main(sys.argv)
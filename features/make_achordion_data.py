@@ -0,0 +1,294 @@
+# Copyright 2024 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Python program to make achordion_data.h.
+
+This program evaluates a tap-hold policy over every matrix position of a keymap
+and generates a C header "achordion_data.h" with the results as PROGMEM tables
+indexed by matrix position. With the tables, Achordion and the QMK tap-hold
+callbacks make constant-time table reads instead of evaluating switch
+statements on every event. Run this program like
+
+$ python3 make_achordion_data.py achordion_policy.py info.json keymap.c
+
+where info.json describes the keyboard layout. It can be made with
+
+$ qmk info -kb <keyboard> -f json > info.json
+
+or given as "-" to read it from stdin. The output is written to
+"achordion_data.h" in the same directory as the policy. Or optionally specify
+the output .h file as a fourth argument. The file is only rewritten if its
+contents change, so that it can be made on every build. The rules.mk in this
+repo does so when ACHORDION_DATA_ENABLE = yes.
+
+The policy is a Python file defining any of the following functions. Each is
+called with a `Key` for a matrix position, having fields `keycode` (the
+keycode as written in the keymap's base layer, with whitespace removed), `row`,
+`col`, and `left_hand`. A function returning None for a key, or not being
+defined, leaves the value unspecified, in which case the corresponding
+callback is called at runtime.
+
+    is_tap_hold(key) -> bool         Whether the key is a tap-hold key.
+    tapping_term(key) -> int         Like get_tapping_term().
+    quick_tap_term(key) -> int       Like get_quick_tap_term().
+    retro_tapping(key) -> bool       Like get_retro_tapping().
+    timeout(key) -> int              Like achordion_timeout().
+    streak_timeout(key) -> int       Like achordion_streak_chord_timeout().
+    chord(tap_hold_key, other_key) -> bool
+                                     Like achordion_chord().
+
+For full documentation, see
+https://getreuer.info/posts/keyboards/achordion
+"""
+
+import collections
+import importlib.util
+import json
+import os.path
+import re
+import sys
+import textwrap
+from typing import Any, Callable, Dict, List, Optional
+
+Key = collections.namedtuple('Key', ['keycode', 'row', 'col', 'left_hand'])
+
+# Value marking an unspecified table entry, for 8-bit and 16-bit entries.
+UNSET_BYTE = 0xff
+UNSET_WORD = 0xffff
+
+# Flag bits in the `achordion_flags_data` table.
+FLAG_RETRO_TAPPING = 1
+FLAG_RETRO_TAPPING_SET = 2
+
+
+def load_policy(file_name: str) -> Any:
+  """Loads the policy Python file as a module."""
+  spec = importlib.util.spec_from_file_location('achordion_policy', file_name)
+  policy = importlib.util.module_from_spec(spec)
+  spec.loader.exec_module(policy)
+  return policy
+
+
+def parse_layout_matrix(file_name: str) -> Dict[str, Any]:
+  """Parses matrix size and layout positions from a QMK info.json file."""
+  if file_name == '-':
+    info = json.load(sys.stdin)
+  else:
+    with open(file_name, 'rt') as f:
+      info = json.load(f)
+
+  rows = info['matrix_size']['rows']
+  cols = info['matrix_size']['cols']
+  split = info.get('split', {}).get('enabled', False)
+  layouts = {name: [tuple(k['matrix']) for k in layout['layout']]
+             for name, layout in info['layouts'].items()}
+  return {'rows': rows, 'cols': cols, 'split': split, 'layouts': layouts}
+
+
+def parse_base_layer(file_name: str) -> Any:
+  """Parses the name and keycodes of the first layer in keymap.c."""
+  with open(file_name, 'rt') as f:
+    text = f.read()
+  # Strip comments.
+  text = re.sub(r'//[^\n]*|/\*.*?\*/', '', text, flags=re.DOTALL)
+
+  match = re.search(r'keymaps\s*\[\s*\]\s*\[.*?=\s*{.*?=\s*(\w+)\s*\(', text,
+                    flags=re.DOTALL)
+  if not match:
+    print(f'Error: Could not find keymaps[] in {file_name}.')
+    sys.exit(1)
+
+  # Split the layout macro args on top-level commas.
+  keycodes = []
+  depth = 0
+  token = ''
+  for c in text[match.end():]:
+    if c == ')' and depth == 0:
+      break
+    elif c == ',' and depth == 0:
+      keycodes.append(token)
+      token = ''
+      continue
+    depth += (c == '(') - (c == ')')
+    token += c
+  keycodes.append(token)
+
+  keycodes = [re.sub(r'\s+', '', k) for k in keycodes]
+  return match.group(1), [k for k in keycodes if k]
+
+
+def on_left_hand(row: int, col: int, matrix: Dict[str, Any]) -> bool:
+  """Returns true if (row, col) is on the left hand, like achordion.c."""
+  if matrix['split']:
+    return row < matrix['rows'] // 2
+  elif matrix['cols'] > matrix['rows']:
+    return col < matrix['cols'] // 2
+  else:
+    return row < matrix['rows'] // 2
+
+
+def make_keys(matrix: Dict[str, Any], layout_name: str,
+              keycodes: List[str]) -> List[Key]:
+  """Makes a Key for every matrix position, in row-major order."""
+  positions = matrix['layouts'].get(layout_name)
+  if positions is None:
+    print(f'Error: Layout {layout_name} is not in info.json.')
+    sys.exit(1)
+  elif len(positions) != len(keycodes):
+    print(f'Error: {layout_name} has {len(positions)} keys, but the keymap '
+          f'has {len(keycodes)}.')
+    sys.exit(1)
+
+  keycode_at = {pos: keycode for pos, keycode in zip(positions, keycodes)}
+  return [Key(keycode_at.get((row, col), 'KC_NO'), row, col,
+              on_left_hand(row, col, matrix))
+          for row in range(matrix['rows']) for col in range(matrix['cols'])]
+
+
+def evaluate(policy: Any, name: str, key: Key) -> Optional[Any]:
+  """Calls the policy function `name` on `key`, if it is defined."""
+  fun: Optional[Callable[[Key], Any]] = getattr(policy, name, None)
+  return fun(key) if fun else None
+
+
+def make_tables(policy: Any, keys: List[Key]) -> Dict[str, List[int]]:
+  """Evaluates the policy over all keys to make the data tables."""
+
+  def encode(name: str, key: Key, unset: int) -> int:
+    value = evaluate(policy, name, key)
+    if value is None:
+      return unset
+    elif not (0 <= value < unset):
+      print(f'Error: {name}() returned {value} for {key.keycode}, out of '
+            f'range 0-{unset - 1}.')
+      sys.exit(1)
+    return int(value)
+
+  tables = collections.defaultdict(list)
+  tap_hold_keys = []
+  listed_keys = []
+  for key in keys:
+    tables['tapping_term'].append(encode('tapping_term', key, UNSET_WORD))
+    tables['timeout'].append(encode('timeout', key, UNSET_WORD))
+    tables['quick_tap_term'].append(encode('quick_tap_term', key, UNSET_BYTE))
+    tables['streak_timeout'].append(encode('streak_timeout', key, UNSET_BYTE))
+    retro_tapping = evaluate(policy, 'retro_tapping', key)
+    tables['flags'].append(
+        0 if retro_tapping is None else
+        FLAG_RETRO_TAPPING_SET | (FLAG_RETRO_TAPPING if retro_tapping else 0))
+
+    is_tap_hold = evaluate(policy, 'is_tap_hold', key)
+    if is_tap_hold:
+      listed_keys.append(key)
+    if hasattr(policy, 'chord') and is_tap_hold:
+      tables['chord_index'].append(len(tap_hold_keys))
+      tap_hold_keys.append(key)
+    else:
+      tables['chord_index'].append(UNSET_BYTE)
+
+  if len(tap_hold_keys) >= UNSET_BYTE:
+    print('Error: Too many tap-hold keys for the chord table.')
+    sys.exit(1)
+
+  # For each tap-hold key, a bit row over all keys of whether they chord.
+  row_bytes = (len(keys) + 7) // 8
+  for tap_hold_key in tap_hold_keys:
+    bits = [0] * row_bytes
+    for i, other_key in enumerate(keys):
+      if policy.chord(tap_hold_key, other_key):
+        bits[i // 8] |= 1 << (i % 8)
+    tables['chord'] += bits
+
+  tables['tap_hold_keys'] = listed_keys
+  tables['chord_bytes'] = row_bytes
+  return tables
+
+
+def write_generated_code(matrix: Dict[str, Any], keys: List[Key],
+                         tables: Dict[str, Any], file_name: str) -> None:
+  """Writes the tables as generated C code to `file_name`."""
+
+  def format_value(value: int, unset: int) -> str:
+    return '-' if value == unset else str(value)
+
+  def array(c_type: str, name: str, data: List[int]) -> str:
+    return textwrap.fill(
+        f'static const {c_type} {name}[{len(data)}] PROGMEM = '
+        '{%s};' % ', '.join(map(str, data)),
+        width=80, subsequent_indent='  ') + '\n\n'
+
+  tap_hold_keys = tables['tap_hold_keys']
+  width = max([len(key.keycode) for key in tap_hold_keys] + [7])
+  listing = ''.join(
+      f'//   {key.row:>3},{key.col:<3} {key.keycode:<{width}} '
+      f'{format_value(tables["tapping_term"][i], UNSET_WORD):>7} '
+      f'{format_value(tables["quick_tap_term"][i], UNSET_BYTE):>6} '
+      f'{format_value(tables["timeout"][i], UNSET_WORD):>7} '
+      f'{format_value(tables["streak_timeout"][i], UNSET_BYTE):>6}\n'
+      for i, key in enumerate(keys) if key in tap_hold_keys)
+
+  generated_code = ''.join([
+    '// Generated code.\n\n',
+    f'// Achordion tap-hold data for a {matrix["rows"]}x{matrix["cols"]} '
+    f'matrix ({len(tap_hold_keys)} tap-hold keys):\n',
+    f'//   pos     {"keycode":<{width}}    term  quick timeout streak\n',
+    listing,
+    f'\n#define ACHORDION_DATA_ROWS {matrix["rows"]}\n',
+    f'#define ACHORDION_DATA_COLS {matrix["cols"]}\n',
+    f'#define ACHORDION_DATA_CHORD_BYTES {tables["chord_bytes"]}\n\n',
+    array('uint16_t', 'achordion_tapping_term_data', tables['tapping_term']),
+    array('uint16_t', 'achordion_timeout_data', tables['timeout']),
+    array('uint8_t', 'achordion_quick_tap_term_data',
+          tables['quick_tap_term']),
+    array('uint8_t', 'achordion_streak_timeout_data',
+          tables['streak_timeout']),
+    array('uint8_t', 'achordion_flags_data', tables['flags']),
+    array('uint8_t', 'achordion_chord_index_data', tables['chord_index']),
+    array('uint8_t', 'achordion_chord_data', tables['chord'] or [0]),
+  ])
+
+  if os.path.exists(file_name):
+    with open(file_name, 'rt') as f:
+      if f.read() == generated_code:
+        return  # Unchanged, leave the file as is to avoid rebuilding.
+  with open(file_name, 'wt') as f:
+    f.write(generated_code)
+
+
+def get_default_h_file(policy_file: str) -> str:
+  return os.path.join(os.path.dirname(policy_file), 'achordion_data.h')
+
+
+def main(argv):
+  if len(argv) < 4:
+    print(__doc__)
+    sys.exit(1)
+
+  policy_file, info_file, keymap_file = argv[1:4]
+  h_file = argv[4] if len(argv) > 4 else get_default_h_file(policy_file)
+
+  policy = load_policy(policy_file)
+  matrix = parse_layout_matrix(info_file)
+  layout_name, keycodes = parse_base_layer(keymap_file)
+  keys = make_keys(matrix, layout_name, keycodes)
+  tables = make_tables(policy, keys)
+
+  num_bytes = (2 * 2 + 4) * len(keys) + len(tables['chord'])
+  print(f'Processed {len(tables["tap_hold_keys"])} tap-hold keys to tables '
+        f'with {num_bytes} bytes.')
+  write_generated_code(matrix, keys, tables, h_file)
+
+
+if __name__ == '__main__':
+  main(sys.argv)
@@ -29,6 +29,48 @@ dictionary. Or optionally specify the output .h file as well like
 
 $ python3 make_autocorrection_data.py dict.txt somewhere/out.h
 
+Several dictionaries separated by commas are merged as layers into one trie,
+where each leaf has a mask of the layers that have the typo, so that shared
+parts are stored once. The firmware corrects only the typos of the enabled
+layers, e.g. for a "code" and a "prose" mode, set at runtime with
+autocorrection_set_layers(). Layer i has mask bit 1 << i.
+
+$ python3 make_autocorrection_data.py code.txt,prose.txt
+
+The flash used is printed against building the dictionaries separately. Layers
+are not supported with --automaton.
+
+Options:
+
+  --automaton     Instead of the trie, generate an automaton with failure
+                  links (Aho-Corasick style). The firmware then makes one
+                  transition per keystroke rather than walking the trie
+                  backwards over the typed keys, at the cost of a larger table.
+                  The flash and PROGMEM reads of both formats are printed for
+                  comparison.
+  --no_minimize   Serialize the plain trie, without merging identical subtrees
+                  and pooling the correction strings. By default, the bytes
+                  saved by minimizing are printed.
+  --bitmap_nodes  Allow trie nodes with many children to be stored with a
+                  bitmap of the children, found in constant time by popcount
+                  rather than by a linear search. The format is chosen per node,
+                  whichever is smaller. The lookup cost with and without bitmap
+                  nodes is printed for comparison.
+  --packed_strings
+                  Store the correction strings as 5-bit codes rather than
+                  bytes, unpacked by the firmware as it sends them. Lowercase
+                  letters, ', space, '_', and '-' take 5 bits, other characters
+                  13 bits. The bytes saved are printed.
+  --quick_reject  Also generate a bitset of the pairs of symbols that typos
+                  end with, so that the firmware skips the trie walk when the
+                  last two keys rule out a typo, as for most keys. The bitset
+                  takes a bit per pair, 98 bytes, or 211 bytes with identifier
+                  symbols. The fraction of keys rejected is printed. Not used
+                  with --automaton, which makes one transition per key anyway.
+  --jobs=N        Check the typos against the English dictionary with N
+                  processes (default 1). Worthwhile for dictionaries of tens
+                  of thousands of entries.
+
 Each line of the dict file defines one typo and its correction with the syntax
 "typo -> correction". Blank lines or lines starting with '#' are ignored.
 Example:
@@ -40,16 +82,27 @@ Example:
     ouput      -> output
     widht      -> width
 
-See autocorrection_dict_extra.txt for a larger example.
+Besides letters and ', typos may use the identifier symbols 0-9, '_', '-', and
+'.', for instance "sefl. -> self." or "lenght_ -> length_". Then the firmware
+buffers these keys as themselves rather than as word breaks, and the generator
+copies each typo that starts or ends with a word break, e.g. ":thier" also as
+"_thier", "-thier", and ".thier", so that '_', '-', and '.' still end words
+(digits are part of words). The flash used for this is printed.
+
+See autocorrection_dict_extra.txt for a larger example. To measure a dictionary
+on real text, the time and PROGMEM reads per key and the corrections it makes
+on correctly spelled words, use tools/autocorrection_sim/bench.py.
 
 For full documentation, see
 https://getreuer.info/posts/keyboards/autocorrection
 """
 
+import collections
+import multiprocessing
 import os.path
 import sys
 import textwrap
-from typing import Any, Dict, Iterator, List, Tuple
+from typing import Any, Dict, Iterable, Iterator, List, Optional, Tuple
 
 try:
   from english_words import english_words_lower_alpha_set as CORRECT_WORDS
@@ -65,20 +118,52 @@ except ImportError:
                    'technology', 'virtually', 'wealthier', 'wonderful')
 
 KC_A = 4
+KC_1 = 0x1e
 KC_SPC = 0x2c
+KC_MINS = 0x2d
 KC_QUOT = 0x34
+KC_DOT = 0x37
+# Code for '_', which is typed as shifted KC_MINS. The value is unused by
+# keycodes.
+UNDERSCORE = 2
 
 TYPO_CHARS = dict(
   [
     ("'", KC_QUOT),
     (':', KC_SPC),  # "Word break" character.
+    # Identifier symbols.
+    ('_', UNDERSCORE),
+    ('-', KC_MINS),
+    ('.', KC_DOT),
   ] +
   # Characters a-z.
-  [(chr(c), c + KC_A - ord('a')) for c in range(ord('a'), ord('z') + 1)]
+  [(chr(c), c + KC_A - ord('a')) for c in range(ord('a'), ord('z') + 1)] +
+  # Digits 1-9, 0.
+  [(c, i + KC_1) for i, c in enumerate('1234567890')]
 )
+KEYCODE_CHARS = {keycode: c for c, keycode in TYPO_CHARS.items()}
+
+# Typo characters in the order of the symbol index computed by
+# autocorrection_symbol() in autocorrection.c, used by the automaton and bitmap
+# nodes.
+SYMBOLS = 'abcdefghijklmnopqrstuvwxyz\':'
+# Symbols that follow SYMBOLS when a typo uses any of them. The firmware then
+# buffers them as themselves instead of as word breaks (AUTOCORRECTION_
+# IDENTIFIERS), so that typos in identifiers like "self.heigth" can be matched.
+IDENTIFIER_SYMBOLS = '1234567890_-.'
+# Identifier symbols that otherwise are word breaks. Digits are part of words.
+BREAK_SYMBOLS = '_-.'
+# First byte of a trie node with a bitmap of its children. The value is unused
+# by the keycodes in TYPO_CHARS.
+BITMAP_NODE = 1
+# Characters of packed correction strings, indexed by their 5-bit code. Code 0
+# ends the string, and PACKED_ESCAPE is followed by any other character in 8
+# bits. Matches send_packed_string() in autocorrection.c.
+PACKED_CHARS = '\0abcdefghijklmnopqrstuvwxyz\' _-'
+PACKED_ESCAPE = 31
 
 
-def parse_file(file_name: str) -> List[Tuple[str, str]]:
+def parse_file(file_name: str, jobs: int = 1) -> List[Tuple[str, str]]:
   """Parses autocorrections dictionary file.
 
   Each line of the file defines one typo and its correction with the syntax
@@ -89,14 +174,15 @@ def parse_file(file_name: str) -> List[Tuple[str, str]]:
 
   Args:
     file_name: String, path of the autocorrections dictionary.
+    jobs: Number of processes for checking against CORRECT_WORDS.
   Returns:
     List of (typo, correction) tuples.
   """
 
   autocorrections = []
-  typos = set()
+  line_numbers = {}
   for line_number, typo, correction in parse_file_lines(file_name):
-    if typo in typos:
+    if typo in line_numbers:
       print(f'Warning:{line_number}: Ignoring duplicate typo: "{typo}"')
       continue
 
@@ -105,24 +191,176 @@ def parse_file(file_name: str) -> List[Tuple[str, str]]:
       print(f'Error:{line_number}: Typo "{typo}" has '
             'characters other than ' + ''.join(TYPO_CHARS.keys()))
       sys.exit(1)
-    for other_typo in typos:
-      if typo in other_typo or other_typo in typo:
-        print(f'Error:{line_number}: Typos may not be substrings of one '
-              f'another, otherwise the longer typo would never trigger: '
-              f'"{typo}" vs. "{other_typo}".')
-        sys.exit(1)
     if len(typo) < 5:
       print(f'Warning:{line_number}: It is suggested that typos are at '
             f'least 5 characters long to avoid false triggers: "{typo}"')
 
-    check_typo_against_dictionary(line_number, typo)
-
     autocorrections.append((typo, correction))
-    typos.add(typo)
+    line_numbers[typo] = line_number
 
+  # Check that typos are not substrings of one another. Report the conflict
+  # that is earliest in the file.
+  conflicts = [(max(line_numbers[typo], line_numbers[other_typo]), typo,
+                other_typo)
+               for typo, other_typo in find_substring_typos(line_numbers)]
+  if conflicts:
+    line_number, typo, other_typo = min(conflicts)
+    if line_numbers[typo] != line_number:
+      typo, other_typo = other_typo, typo
+    print(f'Error:{line_number}: Typos may not be substrings of one '
+          f'another, otherwise the longer typo would never trigger: '
+          f'"{typo}" vs. "{other_typo}".')
+    sys.exit(1)
+
+  check_typos_against_dictionary(line_numbers, jobs)
   return autocorrections
 
 
+class TypoIndex(set):
+  """Set of typos, with the sorted distinct lengths for find_substrings()."""
+
+  def __init__(self, typos: Iterable[str]):
+    super().__init__(typos)
+    self.lengths = sorted({len(typo) for typo in self})
+
+
+def find_substrings(index: TypoIndex, text: str) -> Iterator[str]:
+  """Finds the typos that occur as substrings of `text`.
+
+  The index is probed with each substring of `text` that has the length of a
+  typo, taking time proportional to len(text) times the number of distinct
+  typo lengths, rather than to the number of typos.
+  """
+  for i in range(len(text)):
+    for n in index.lengths:
+      if i + n > len(text):
+        break
+      if text[i:i + n] in index:
+        yield text[i:i + n]
+
+
+def find_substring_typos(typos: Iterable[str]) -> Iterator[Tuple[str, str]]:
+  """Finds pairs (typo, other_typo) where other_typo is a substring of typo."""
+  index = TypoIndex(typos)
+  for typo in index:
+    for other_typo in find_substrings(index, typo):
+      if other_typo != typo:
+        yield typo, other_typo
+
+
+def find_false_triggers(args: Tuple[List[str], List[str]]
+                        ) -> List[Tuple[str, str]]:
+  """Finds (typo, word) pairs where the typo would trigger on the word."""
+  typos, words = args
+  index = TypoIndex(typos)
+  # Within ":word:", the typos ":x" match words starting with x, "x:" match
+  # words ending with x, and ":x:" match the word x.
+  return [(typo, word) for word in words
+          for typo in find_substrings(index, f':{word}:')]
+
+
+def layer_names(file_names: List[str], layer_mask: int) -> str:
+  """Lists the files of the layers in `layer_mask`."""
+  return ', '.join(f for i, f in enumerate(file_names) if layer_mask >> i & 1)
+
+
+def merge_layers(file_names: List[str], layers: List[List[Tuple[str, str]]]
+                 ) -> Tuple[List[Tuple[str, str]], Dict[str, int]]:
+  """Merges dictionaries as layers of one trie.
+
+  Args:
+    file_names: List of the dictionary file names, for messages.
+    layers: List of the autocorrections of each dictionary.
+  Returns:
+    (autocorrections, layer_masks) tuple, the merged list of (typo, correction)
+    tuples, and a dict of the mask of the layers that have each typo.
+  """
+  if len(layers) > 8:
+    print('Error: At most 8 dictionaries can be merged as layers.')
+    sys.exit(1)
+
+  corrections = {}
+  layer_masks = {}
+  for i, autocorrections in enumerate(layers):
+    for typo, correction in autocorrections:
+      if corrections.setdefault(typo, correction) != correction:
+        print(f'Error: Typo "{typo}" has different corrections in '
+              f'{file_names[i]} and an earlier layer: "{correction}" vs. '
+              f'"{corrections[typo]}".')
+        sys.exit(1)
+      layer_masks[typo] = layer_masks.get(typo, 0) | 1 << i
+
+  # The trie is written in reverse, so a typo that ends with another typo would
+  # need a leaf inside the path of the other. Substrings that are not suffixes
+  # are fine; when both layers are enabled, the shorter typo triggers first.
+  for typo, other_typo in find_substring_typos(layer_masks):
+    if typo.endswith(other_typo):
+      print(f'Error: Typo "{other_typo}" '
+            f'({layer_names(file_names, layer_masks[other_typo])}) is a suffix '
+            f'of "{typo}" ({layer_names(file_names, layer_masks[typo])}), so '
+            'they cannot be merged as layers.')
+      sys.exit(1)
+
+  return list(corrections.items()), layer_masks
+
+
+def get_symbols(autocorrections: Iterable[Tuple[str, str]]) -> str:
+  """Gets the symbols of the dictionary, with identifier symbols if used."""
+  if any(c in IDENTIFIER_SYMBOLS for typo, _ in autocorrections for c in typo):
+    return SYMBOLS + IDENTIFIER_SYMBOLS
+  return SYMBOLS
+
+
+def expand_word_breaks(autocorrections: List[Tuple[str, str]],
+                       layer_masks: Optional[Dict[str, int]] = None
+                       ) -> List[Tuple[str, str]]:
+  """Adds copies of typos for the word breaks that are identifier symbols.
+
+  With identifier symbols, the firmware buffers '_', '-', and '.' as themselves
+  rather than as the word break ':'. So that they still end words, a typo that
+  starts or ends with ':' is copied with each of them in its place, e.g.
+  ":thier -> their" as "_thier -> _their". Unlike ':', a symbol ending a typo
+  is part of it, so the correction types it. Copies that are a typo of the
+  dictionary or conflict with one are dropped.
+
+  Args:
+    autocorrections: List of (typo, correction) tuples.
+    layer_masks: Optional dict of the layer mask of each typo, to which the
+      masks of the copies are added.
+  Returns:
+    List of (typo, correction) tuples, the dictionary followed by the copies.
+  """
+  if get_symbols(autocorrections) == SYMBOLS:
+    return autocorrections
+
+  copies = {}
+  for typo, correction in autocorrections:
+    word = typo.strip(':')
+    starts = ':' + BREAK_SYMBOLS if typo.startswith(':') else ['']
+    ends = ':' + BREAK_SYMBOLS if typo.endswith(':') else ['']
+    for start in starts:
+      for end in ends:
+        copy = start + word + end
+        if copy != typo:
+          copies[copy] = (start.strip(':') + correction + end.strip(':'))
+          if layer_masks is not None:
+            layer_masks.setdefault(copy, layer_masks[typo])
+
+  # Drop the copies that are typos of the dictionary or conflict with one, and
+  # of two conflicting copies, the longer, which could never trigger.
+  typos = {typo for typo, _ in autocorrections}
+  for copy in list(copies):
+    if copy in typos:
+      del copies[copy]
+  for typo, other_typo in find_substring_typos(typos | copies.keys()):
+    if other_typo in copies and typo in typos:
+      copies.pop(other_typo, None)
+    else:
+      copies.pop(typo, None)
+
+  return autocorrections + sorted(copies.items())
+
+
 def make_trie(autocorrections: List[Tuple[str, str]]) -> Dict[str, Any]:
   """Makes a trie from the the typos, writing in reverse.
 
@@ -162,95 +400,396 @@ def parse_file_lines(file_name: str) -> Iterator[Tuple[int, str, str]]:
       yield line_number, typo, correction
 
 
-def check_typo_against_dictionary(line_number: int, typo: str) -> None:
-  """Checks `typo` against English dictionary words."""
+def check_typos_against_dictionary(line_numbers: Dict[str, int],
+                                   jobs: int = 1) -> None:
+  """Checks the typos against English dictionary words.
 
-  if typo.startswith(':') and typo.endswith(':'):
-    if typo[1:-1] in CORRECT_WORDS:
+  Args:
+    line_numbers: Dict of the line number of each typo.
+    jobs: Number of processes to split the dictionary words over.
+  """
+  typos = list(line_numbers)
+  words = sorted(CORRECT_WORDS)
+  if jobs > 1:
+    chunk = -(-len(words) // jobs)
+    with multiprocessing.Pool(jobs) as pool:
+      results = pool.map(find_false_triggers,
+                         [(typos, words[i:i + chunk])
+                          for i in range(0, len(words), chunk)])
+    matches = [match for result in results for match in result]
+  else:
+    matches = find_false_triggers((typos, words))
+
+  for typo, word in sorted(matches, key=lambda m: (line_numbers[m[0]], m[1])):
+    line_number = line_numbers[typo]
+    if typo.startswith(':') and typo.endswith(':'):
       print(f'Warning:{line_number}: Typo "{typo}" is a correctly spelled '
             'dictionary word.')
-  elif typo.startswith(':') and not typo.endswith(':'):
-    for word in CORRECT_WORDS:
-      if word.startswith(typo[1:]):
-        print(f'Warning:{line_number}: Typo "{typo}" would falsely trigger '
-              f'on correctly spelled word "{word}".')
-  elif not typo.startswith(':') and typo.endswith(':'):
-    for word in CORRECT_WORDS:
-      if word.endswith(typo[:-1]):
-        print(f'Warning:{line_number}: Typo "{typo}" would falsely trigger '
-              f'on correctly spelled word "{word}".')
-  elif not typo.startswith(':') and not typo.endswith(':'):
-    for word in CORRECT_WORDS:
-      if typo in word:
-        print(f'Warning:{line_number}: Typo "{typo}" would falsely trigger '
-              f'on correctly spelled word "{word}".')
+    else:
+      print(f'Warning:{line_number}: Typo "{typo}" would falsely trigger '
+            f'on correctly spelled word "{word}".')
 
 
 def serialize_trie(autocorrections: List[Tuple[str, str]],
-                   trie: Dict[str, Any]) -> List[int]:
+                   trie: Dict[str, Any],
+                   bitmap_nodes: bool = False,
+                   minimize: bool = True,
+                   packed_strings: bool = False,
+                   layer_masks: Optional[Dict[str, int]] = None) -> List[int]:
   """Serializes trie and correction data in a form readable by the C code.
 
+  With `minimize`, the trie is minimized to a directed acyclic word graph
+  (DAWG): identical subtrees are serialized once, and nodes link to the shared
+  copy. Correction strings that are used by several leaves or are a suffix of
+  another are moved to a string pool at the end of the table, to which the
+  leaves link.
+
   Args:
     autocorrections: List of (typo, correction) tuples.
     trie: Dict of dicts.
+    bitmap_nodes: Whether to store nodes with many children as bitmap nodes,
+      when it is no larger than a list of the children.
+    minimize: Whether to merge identical subtrees and pool the strings.
+    packed_strings: Whether to pack the correction strings with pack_string().
+    layer_masks: For layered dictionaries, dict of the layer mask of each typo,
+      stored in its leaf.
   Returns:
     List of ints in the range 0-255.
   """
+  symbols = get_symbols(autocorrections)
+  # Bytes before the string of a leaf, the backspaces and the layer mask.
+  leaf_header = 2 if layer_masks else 1
+
+  def serialize_leaf(trie_node: Dict[str, Any]) -> List[int]:
+    typo, correction = trie_node['LEAF']
+    return serialize_correction(typo, correction, packed_strings,
+                                layer_masks[typo] if layer_masks else None)
+
+  bitmap_bytes = (len(symbols) + 7) // 8
   table = []
+  # For minimizing, the serialized entry of each distinct subtree.
+  subtrees = {}
+  # Each distinct subtree is identified by an int, assigned in `subtree_ids`
+  # from the subtree's leaf data or children. This way, comparing subtrees
+  # takes time proportional to the number of children.
+  subtree_ids = {}
+  subtree_keys = {}
+
+  def subtree_key(trie_node: Dict[str, Any]) -> int:
+    """Gets a key that is equal for identical subtrees."""
+    if id(trie_node) not in subtree_keys:
+      if 'LEAF' in trie_node:
+        key = tuple(serialize_leaf(trie_node))
+      else:
+        key = tuple((c, subtree_key(child))
+                    for c, child in sorted(trie_node.items()))
+      subtree_keys[id(trie_node)] = subtree_ids.setdefault(key,
+                                                           len(subtree_ids))
+    return subtree_keys[id(trie_node)]
 
   # Traverse trie in depth first order.
-  def traverse(trie_node: Dict[str, Any]) -> Dict[str, Any]:
-    if 'LEAF' in trie_node:  # Handle a leaf trie node.
-      typo, correction = trie_node['LEAF']
-      word_boundary_ending = typo[-1] == ':'
-      typo = typo.strip(':')
-      i = 0  # Make the autocorrection data for this entry and serialize it.
-      while i < min(len(typo), len(correction)) and typo[i] == correction[i]:
-        i += 1
-      backspaces = len(typo) - i - 1 + word_boundary_ending
-      assert 0 <= backspaces <= 63
-      correction = correction[i:]
-      data = [backspaces + 128] + list(bytes(correction, 'ascii')) + [0]
+  def traverse(trie_node: Dict[str, Any],
+               share: bool = True) -> Dict[str, Any]:
+    if minimize and share and subtree_key(trie_node) in subtrees:
+      return subtrees[subtree_key(trie_node)]
 
+    if 'LEAF' in trie_node:  # Handle a leaf trie node.
+      data = serialize_leaf(trie_node)
       entry = {'data': data, 'links': [], 'byte_offset': 0}
       table.append(entry)
     elif len(trie_node) == 1:  # Handle trie node with a single child.
-      c, trie_node = next(iter(trie_node.items()))
+      c, child = next(iter(trie_node.items()))
       entry = {'chars': c, 'byte_offset': 0}
 
       # It's common for a trie to have long chains of single-child nodes. We
       # find the whole chain so that we can serialize it more efficiently.
-      while len(trie_node) == 1 and 'LEAF' not in trie_node:
-        c, trie_node = next(iter(trie_node.items()))
+      while len(child) == 1 and 'LEAF' not in child:
+        c, child = next(iter(child.items()))
         entry['chars'] += c
 
       table.append(entry)
-      entry['links'] = [traverse(trie_node)]
+      size = len(table)
+      link = traverse(child)
+      if len(table) == size:
+        # The child is a shared subtree elsewhere in the table, so the chain
+        # ends in a link to it. This costs 3 bytes, not worth it for a leaf
+        # that is no larger.
+        if 'data' in link and len(link['data']) <= 3:
+          link = traverse(child, share=False)
+        else:
+          entry['shared'] = True
+      entry['links'] = [link]
     else:  # Handle trie node with multiple children.
       entry = {'chars': ''.join(sorted(trie_node.keys())), 'byte_offset': 0}
       table.append(entry)
       entry['links'] = [traverse(trie_node[c]) for c in entry['chars']]
+
+    if minimize and share:
+      subtrees[subtree_key(trie_node)] = entry
     return entry
 
   traverse(trie)
 
+  # Make the string pool of correction strings, keyed by their serialized bytes
+  # with the terminator. Leaves with the same string but different layer masks
+  # share it. Strings are placed longest first, so that a string
+  # whose bytes are a suffix of a placed string's is shared. This holds for
+  # packed strings too, as a string is decoded from its bytes alone.
+  pool = []
+  pool_offsets = {}
+  if minimize:
+    leaves = collections.defaultdict(list)
+    for e in table:
+      if not e['links']:
+        leaves[bytes(e['data'][leaf_header:])].append(e)
+    for string in sorted(leaves, key=lambda x: (-len(x), x)):
+      n = len(leaves[string])
+      if string in pool_offsets:
+        pooled = len(string) > 2  # 2-byte link vs. inline string.
+      else:
+        pooled = n * (len(string) - 2) > len(string)
+        if pooled:
+          for i in range(len(string) - 1):
+            pool_offsets.setdefault(string[i:], len(pool) + i)
+          pool += list(string)
+      if pooled:
+        for e in leaves[string]:
+          e['string'] = string
+
   def serialize(e: Dict[str, Any]) -> List[int]:
     if not e['links']:  # Handle a leaf table entry.
+      if 'string' in e:  # Link to the string in the pool.
+        return [e['data'][0] | 64] + e['data'][1:leaf_header] + encode_link(
+            {'byte_offset': pool_base + pool_offsets[e['string']]})
       return e['data']
     elif len(e['links']) == 1:  # Handle a chain table entry.
+      if e.get('shared'):
+        # End the chain with a branch entry with one child, to link to it.
+        *chars, c = e['chars']
+        return ([TYPO_CHARS[c] for c in chars] + [0] if chars else []) + (
+            [TYPO_CHARS[c] | 64] + encode_link(e['links'][0]) + [0])
       return [TYPO_CHARS[c] for c in e['chars']] + [0]
+    elif bitmap_nodes and (1 + bitmap_bytes + 2 * len(e['links']) <=
+                           1 + 3 * len(e['links'])):
+      # Handle a branch table entry as a bitmap node: a bitmap of which symbols
+      # have children, followed by the links in order of symbol.
+      bitmap = sum(1 << symbols.index(c) for c in e['chars'])
+      data = [BITMAP_NODE] + list(bitmap.to_bytes(bitmap_bytes, 'little'))
+      for _, link in sorted(zip(e['chars'], e['links']),
+                            key=lambda x: symbols.index(x[0])):
+        data += encode_link(link)
+      return data
     else:  # Handle a branch table entry.
       data = []
       for c, link in zip(e['chars'], e['links']):
         data += [TYPO_CHARS[c] | (0 if data else 64)] + encode_link(link)
       return data + [0]
 
-  byte_offset = 0
+  pool_base = 0
   for e in table:  # To encode links, first compute byte offset of each entry.
-    e['byte_offset'] = byte_offset
-    byte_offset += len(serialize(e))
+    e['byte_offset'] = pool_base
+    pool_base += len(serialize(e))
+
+  # Serialize final table, followed by the string pool.
+  return [b for e in table for b in serialize(e)] + pool
+
+
+def make_quick_reject(autocorrections: List[Tuple[str, str]]) -> List[int]:
+  """Makes the bitset of the symbol pairs that typos end with.
+
+  Bit (last * len(symbols) + previous) is set when a typo ends with the
+  symbols previous, last, or when a typo is only the symbol last.
+  """
+  symbols = get_symbols(autocorrections)
+  bits = [0] * ((len(symbols)**2 + 7) // 8)
+  for typo, _ in autocorrections:
+    last = symbols.index(typo[-1]) * len(symbols)
+    previous = ([symbols.index(typo[-2])] if len(typo) >= 2 else
+                range(len(symbols)))
+    for i in previous:
+      bits[(last + i) >> 3] |= 1 << ((last + i) & 7)
+  return bits
+
+
+def quick_reject_passes(quick_reject: Optional[List[int]], symbols: str,
+                        buffer: List[int]) -> bool:
+  """Models the quick reject in autocorrection.c on the typed `buffer`."""
+  if not quick_reject or len(buffer) < 2:
+    return True
+  i = (symbols.index(KEYCODE_CHARS[buffer[-1]]) * len(symbols) +
+       symbols.index(KEYCODE_CHARS[buffer[-2]]))
+  return bool(quick_reject[i >> 3] & (1 << (i & 7)))
+
+
+def pack_string(string: str) -> List[int]:
+  """Packs a correction string as 5-bit codes of PACKED_CHARS.
+
+  The codes are written most significant bit first, ending with code 0, and
+  padded with zeros to whole bytes.
+  """
+  bits = ''
+  for c in string:
+    if c in PACKED_CHARS[1:]:
+      bits += f'{PACKED_CHARS.index(c):05b}'
+    else:
+      bits += f'{PACKED_ESCAPE:05b}{ord(c):08b}'
+  bits += '0' * (5 + -(len(bits) + 5) % 8)
+  return [int(bits[i:i + 8], 2) for i in range(0, len(bits), 8)]
+
 
-  return [b for e in table for b in serialize(e)]  # Serialize final table.
+def unpack_string(data: List[int], start: int) -> bytes:
+  """Unpacks the string packed at `start`, like send_packed_string()."""
+  bits = ''.join(f'{b:08b}' for b in data[start:])
+  string = b''
+  i = 0
+  while True:
+    code = int(bits[i:i + 5], 2)
+    i += 5
+    if code == 0:
+      return string
+    elif code == PACKED_ESCAPE:
+      string += bytes([int(bits[i:i + 8], 2)])
+      i += 8
+    else:
+      string += bytes(PACKED_CHARS[code], 'ascii')
+
+
+def decode_correction(data: List[int], state: int,
+                      packed_strings: bool = False,
+                      layered: bool = False) -> Tuple[int, bytes]:
+  """Decodes the leaf at `state` as (backspaces, string), like the C code."""
+  backspaces = data[state] & 63
+  string = state + (2 if layered else 1)
+  if data[state] & 64:  # String in the pool.
+    string = data[string] | data[string + 1] << 8
+  if packed_strings:
+    return backspaces, unpack_string(data, string)
+  return backspaces, bytes(data[string:data.index(0, string)])
+
+
+def verify_trie(autocorrections: List[Tuple[str, str]],
+                data: List[int], packed_strings: bool = False,
+                layer_masks: Optional[Dict[str, int]] = None) -> None:
+  """Checks that each typo is found and corrected as expected in the table."""
+  symbols = get_symbols(autocorrections)
+  for typo, correction in autocorrections:
+    state, _ = lookup_trie(data, [TYPO_CHARS[c] for c in typo], symbols)
+    expected = serialize_correction(typo, correction)
+    if (state is None or
+        decode_correction(data, state, packed_strings, bool(layer_masks)) !=
+        (expected[0] & 63, bytes(expected[1:-1])) or
+        (layer_masks and data[state + 1] != layer_masks[typo])):
+      print(f'Error: Internal error, typo "{typo}" is not found correctly in '
+            'the serialized table.')
+      sys.exit(1)
+
+
+def serialize_correction(typo: str, correction: str,
+                         packed_strings: bool = False,
+                         layer_mask: Optional[int] = None) -> List[int]:
+  """Serializes the leaf data for one entry, the backspaces and the string.
+
+  For layered dictionaries, the `layer_mask` byte follows the backspaces.
+  """
+  word_boundary_ending = typo[-1] == ':'
+  typo = typo.strip(':')
+  # Find the common prefix of the typo and correction. Unless the typo ends in a
+  # word break, the last key of the typo is blocked and must be in the string,
+  # even when the typo is a prefix of the correction.
+  n = min(len(typo) - 1 + word_boundary_ending, len(correction))
+  i = 0
+  while i < n and typo[i] == correction[i]:
+    i += 1
+  backspaces = len(typo) - i - 1 + word_boundary_ending
+  assert 0 <= backspaces <= 63
+  correction = correction[i:]
+  header = [backspaces + 128] + ([] if layer_mask is None else [layer_mask])
+  if packed_strings:
+    return header + pack_string(correction)
+  return header + list(bytes(correction, 'ascii')) + [0]
+
+
+def make_automaton(autocorrections: List[Tuple[str, str]],
+                   packed_strings: bool = False) -> List[int]:
+  """Makes and serializes an automaton matching the typos, Aho-Corasick style.
+
+  The states are the prefixes of the typos, and the transition from a state on
+  a symbol goes to the longest suffix of (state + symbol) that is a state. Since
+  typos are not substrings of one another, a typo was typed exactly when the
+  state is that typo.
+
+  The transitions of the root are stored as a row of 2-byte state offsets. Each
+  other state stores only the transitions that differ from the root's, which
+  are the few that continue a partial match. The serialized format is:
+
+    Offset 0: 0 (the root state, with no transitions of its own).
+    Offset 1: Row of the root's transition for each symbol, 2 bytes each.
+    Then for each other state, either a leaf of the same format as in the trie,
+    or the number of transitions n followed by n (symbol, offset low byte,
+    offset high byte) triples, sorted by symbol.
+
+  Args:
+    autocorrections: List of (typo, correction) tuples.
+    packed_strings: Whether to pack the correction strings with pack_string().
+  Returns:
+    List of ints in the range 0-255.
+  """
+  # Build the trie of the typos, written forward.
+  children = [{}]
+  leaves = {}
+  for typo, correction in autocorrections:
+    state = 0
+    for c in typo:
+      if c not in children[state]:
+        children[state][c] = len(children)
+        children.append({})
+      state = children[state][c]
+    leaves[state] = (typo, correction)
+
+  # Compute the transitions in breadth first order from the failure links.
+  symbols = get_symbols(autocorrections)
+  transitions = [None] * len(children)
+  transitions[0] = {c: children[0].get(c, 0) for c in symbols}
+  failure = [0] * len(children)
+  order = [0]
+  queue = collections.deque(children[0].values())
+  while queue:
+    state = queue.popleft()
+    order.append(state)
+    transitions[state] = dict(transitions[failure[state]])
+    for c, child in children[state].items():
+      failure[child] = transitions[failure[state]][c]
+      transitions[state][c] = child
+      queue.append(child)
+
+  # Serialize, storing only the transitions that differ from the root's.
+  def sparse(state: int) -> List[Tuple[int, int]]:
+    return [(i, transitions[state][c])
+            for i, c in enumerate(symbols)
+            if transitions[state][c] != transitions[0][c]]
+
+  offsets = {0: 0}
+  byte_offset = 1 + 2 * len(symbols)
+  for state in order[1:]:
+    offsets[state] = byte_offset
+    if state in leaves:
+      byte_offset += len(serialize_correction(*leaves[state],
+                                              packed_strings))
+    else:
+      byte_offset += 1 + 3 * len(sparse(state))
+
+  data = [0]
+  for c in symbols:
+    data += encode_link({'byte_offset': offsets[transitions[0][c]]})
+  for state in order[1:]:
+    if state in leaves:
+      data += serialize_correction(*leaves[state], packed_strings)
+    else:
+      data.append(len(sparse(state)))
+      for i, target in sparse(state):
+        data += [i] + encode_link({'byte_offset': offsets[target]})
+
+  return data
 
 
 def encode_link(link: Dict[str, Any]) -> List[int]:
@@ -263,33 +802,223 @@ def encode_link(link: Dict[str, Any]) -> List[int]:
   return [byte_offset & 255, byte_offset >> 8]
 
 
+def lookup_trie(data: List[int], buffer: List[int],
+                symbols: str = SYMBOLS) -> Tuple[Optional[int], int]:
+  """Models the trie lookup in autocorrection.c on the typed `buffer`.
+
+  Args:
+    data: The serialized trie.
+    buffer: List of the typed keycodes.
+    symbols: The symbols of the dictionary, from get_symbols().
+  Returns:
+    (state, reads) tuple, the offset of the leaf if a typo was found or None,
+    and the number of PROGMEM bytes read to determine this.
+  """
+  reads = 0
+
+  def read(i: int) -> int:
+    nonlocal reads
+    reads += 1
+    return data[i]
+
+  state = 0
+  code = read(state)
+  for key in reversed(buffer):
+    if code == BITMAP_NODE:  # Node with a bitmap of children.
+      symbol = symbols.index(KEYCODE_CHARS[key])
+      byte = read(state + 1 + (symbol >> 3))
+      if not byte & (1 << (symbol & 7)):
+        return None, reads
+      index = bin(byte & ((1 << (symbol & 7)) - 1)).count('1')
+      for i in range(symbol >> 3):
+        index += bin(read(state + 1 + i)).count('1')
+      state += 1 + (len(symbols) + 7) // 8 + 2 * index
+      state = read(state) | read(state + 1) << 8
+    elif code & 64:  # Node with multiple children.
+      code &= 63
+      while code != key:
+        if not code:
+          return None, reads
+        state += 3
+        code = read(state)
+      state = read(state + 1) | read(state + 2) << 8
+    elif code != key:  # Node with a single child.
+      return None, reads
+    else:
+      state += 1
+      code = read(state)
+      if not code:
+        state += 1
+
+    code = read(state)
+    if code & 128:
+      return state, reads
+
+  return None, reads
+
+
+def step_automaton(data: List[int], state: int,
+                   symbol: int) -> Tuple[int, int]:
+  """Models the automaton transition in autocorrection.c.
+
+  Returns:
+    (state, reads) tuple, the next state and the number of PROGMEM bytes read,
+    including the read of the next state's first byte to check for a typo.
+  """
+  reads = 1
+  offset = state + 1
+  for _ in range(data[state]):
+    reads += 1
+    if data[offset] == symbol:
+      return data[offset + 1] | data[offset + 2] << 8, reads + 3
+    elif data[offset] > symbol:
+      break
+    offset += 3
+  offset = 1 + 2 * symbol
+  return data[offset] | data[offset + 1] << 8, reads + 3
+
+
+def count_reads(autocorrections: List[Tuple[str, str]], data: List[int],
+                automaton: bool, text: str,
+                quick_reject: Optional[List[int]] = None
+                ) -> Tuple[float, int, float]:
+  """Counts PROGMEM reads per key to type `text`, a proxy for CPU cycles.
+
+  Args:
+    autocorrections: List of (typo, correction) tuples.
+    data: The serialized trie or automaton.
+    automaton: Whether `data` is an automaton.
+    text: String of characters in TYPO_CHARS.
+    quick_reject: Optional bitset from make_quick_reject() for the trie.
+  Returns:
+    (mean, worst, rejected) tuple of PROGMEM reads per key, and the fraction of
+    keys for which the trie walk was skipped by `quick_reject`.
+  """
+  symbols = get_symbols(autocorrections)
+  min_length = min(len(typo) for typo, _ in autocorrections)
+  max_length = max(len(typo) for typo, _ in autocorrections)
+  total = worst = rejected = 0
+  buffer = []
+  state = 0
+  for c in text:
+    if automaton:
+      state, reads = step_automaton(data, state, symbols.index(c))
+      if data[state] & 128:  # Typo found, reset as the firmware does.
+        state = data[1 + 2 * symbols.index(':')] if c == ':' else 0
+    else:
+      buffer = (buffer + [TYPO_CHARS[c]])[-max_length:]
+      state, reads = None, 0
+      if len(buffer) >= min_length:
+        if quick_reject_passes(quick_reject, symbols, buffer):
+          state, reads = lookup_trie(data, buffer, symbols)
+        else:
+          rejected += 1
+        if quick_reject and len(buffer) >= 2:
+          reads += 1  # The read of the bitset.
+      if state is not None:
+        buffer = [KC_SPC] if c == ':' else []
+    total += reads
+    worst = max(worst, reads)
+
+  return total / max(len(text), 1), worst, rejected / max(len(text), 1)
+
+
+def worst_case_reads(autocorrections: List[Tuple[str, str]], data: List[int],
+                     automaton: bool) -> int:
+  """Finds the most PROGMEM reads for one key over all possible typed keys."""
+  symbols = get_symbols(autocorrections)
+  worst = 0
+  if automaton:  # Try every transition from every non-leaf state.
+    states = [0]
+    visited = {0}
+    while states:
+      state = states.pop()
+      for symbol in range(len(symbols)):
+        next_state, reads = step_automaton(data, state, symbol)
+        worst = max(worst, reads)
+        if next_state not in visited and not data[next_state] & 128:
+          visited.add(next_state)
+          states.append(next_state)
+  else:  # Try every path into the trie, followed by every symbol.
+    max_length = max(len(typo) for typo, _ in autocorrections)
+    suffixes = {typo[i:] for typo, _ in autocorrections
+                for i in range(len(typo))}
+    for suffix in suffixes:
+      for c in symbols:
+        buffer = [TYPO_CHARS[k] for k in c + suffix][-max_length:]
+        worst = max(worst, lookup_trie(data, buffer, symbols)[1])
+
+  return worst
+
+
+def make_benchmark_text(autocorrections: List[Tuple[str, str]]) -> str:
+  """Makes text to measure lookup cost: the word list, then all typos."""
+  words = sorted(CORRECT_WORDS) + [typo.strip(':')
+                                   for typo, _ in autocorrections]
+  return ':' + ':'.join(w for w in words if all(c in TYPO_CHARS for c in w))
+
+
 def write_generated_code(autocorrections: List[Tuple[str, str]],
                          data: List[int],
-                         file_name: str) -> None:
+                         file_name: str,
+                         automaton: bool = False,
+                         bitmap_nodes: bool = False,
+                         packed_strings: bool = False,
+                         quick_reject: Optional[List[int]] = None,
+                         layer_files: Optional[List[str]] = None,
+                         layer_masks: Optional[Dict[str, int]] = None) -> None:
   """Writes autocorrection data as generated C code to `file_name`.
 
   Args:
     autocorrections: List of (typo, correction) tuples.
-    data: List of ints in 0-255, the serialized trie.
+    data: List of ints in 0-255, the serialized trie or automaton.
     file_name: String, path of the output C file.
+    automaton: Whether `data` is an automaton made by make_automaton().
+    bitmap_nodes: Whether `data` is a trie that may have bitmap nodes.
+    packed_strings: Whether the correction strings in `data` are packed.
+    quick_reject: Optional bitset from make_quick_reject().
+    layer_files: For layered dictionaries, list of the dictionary files.
+    layer_masks: For layered dictionaries, dict of the layer mask of each typo.
   """
   assert all(0 <= b <= 255 for b in data)
 
   def typo_len(e: Tuple[str, str]) -> int:
     return len(e[0])
 
+  def layers(typo: str) -> str:
+    if not layer_masks:
+      return ''
+    return '  [layers %s]' % ', '.join(str(i) for i in range(8)
+                                      if layer_masks[typo] >> i & 1)
+
   min_typo = min(autocorrections, key=typo_len)[0]
   max_typo = max(autocorrections, key=typo_len)[0]
   generated_code = ''.join([
     '// Generated code.\n\n',
+    ''.join(f'// Layer {i} (mask {1 << i}): {os.path.basename(f)}\n'
+            for i, f in enumerate(layer_files or [])),
     f'// Autocorrection dictionary ({len(autocorrections)} entries):\n',
-    ''.join(sorted(f'//   {typo:<{len(max_typo)}} -> {correction}\n'
+    ''.join(sorted(f'//   {typo:<{len(max_typo)}} -> {correction}'
+                   f'{layers(typo)}\n'
                    for typo, correction in autocorrections)),
     f'\n#define AUTOCORRECTION_MIN_LENGTH {len(min_typo)}  // "{min_typo}"\n',
-    f'#define AUTOCORRECTION_MAX_LENGTH {len(max_typo)}  // "{max_typo}"\n\n',
-    textwrap.fill('static const uint8_t autocorrection_data[%d] PROGMEM = {%s};' % (
+    f'#define AUTOCORRECTION_MAX_LENGTH {len(max_typo)}  // "{max_typo}"\n',
+    '#define AUTOCORRECTION_AUTOMATON\n' if automaton else '',
+    '#define AUTOCORRECTION_BITMAP_NODES\n' if bitmap_nodes else '',
+    '#define AUTOCORRECTION_PACKED_STRINGS\n' if packed_strings else '',
+    '#define AUTOCORRECTION_QUICK_REJECT\n' if quick_reject else '',
+    '#define AUTOCORRECTION_LAYERS\n' if layer_masks else '',
+    '#define AUTOCORRECTION_IDENTIFIERS\n'
+    if get_symbols(autocorrections) != SYMBOLS else '',
+    '\n',
+    textwrap.fill('static const uint8_t %s[%d] PROGMEM = {%s};' % (
+      'autocorrection_automaton' if automaton else 'autocorrection_data',
       len(data), ', '.join(map(str, data))), width=80, subsequent_indent='  '),
-    '\n\n'])
+    '\n\n',
+    textwrap.fill(
+      'static const uint8_t autocorrection_quick_reject[%d] PROGMEM = {%s};'
+      % (len(quick_reject), ', '.join(map(str, quick_reject))),
+      width=80, subsequent_indent='  ') + '\n\n' if quick_reject else ''])
 
   with open(file_name, 'wt') as f:
     f.write(generated_code)
@@ -299,16 +1028,172 @@ def get_default_h_file(dict_file: str) -> str:
   return os.path.join(os.path.dirname(dict_file), 'autocorrection_data.h')
 
 
+def print_cost_comparison(autocorrections: List[Tuple[str, str]],
+                          formats: Iterable[Tuple[str, List[int], bool]]
+                          ) -> None:
+  """Prints the flash size and PROGMEM reads per key of each format."""
+  text = make_benchmark_text(autocorrections)
+  print(f'PROGMEM reads per key over {len(text)} keys of the word list and '
+        'typos, and the\nworst case over all possible keys:')
+  for name, data, automaton in formats:
+    mean, worst, _ = count_reads(autocorrections, data, automaton, text)
+    print(f'  {name:<12} {len(data):6d} bytes, mean {mean:5.2f}, '
+          f'worst {worst:3d}, worst possible '
+          f'{worst_case_reads(autocorrections, data, automaton):3d}')
+
+
+def print_quick_reject_cost(entries: List[Tuple[str, str]], data: List[int],
+                            quick_reject: List[int]) -> None:
+  """Prints the keys rejected and PROGMEM reads saved by the quick reject."""
+  text = make_benchmark_text(entries)
+  mean, worst, _ = count_reads(entries, data, False, text)
+  mean_qr, worst_qr, rejected = count_reads(entries, data, False, text,
+                                            quick_reject)
+  print(f'Quick reject: {len(quick_reject)} bytes, skipping the trie walk on '
+        f'{100 * rejected:.1f}% of {len(text)} keys\nof the word list and '
+        f'typos. PROGMEM reads per key go from mean {mean:.2f} to '
+        f'{mean_qr:.2f}, worst\n{worst} to {worst_qr}.')
+
+
+def print_layers_cost(file_names: List[str],
+                      layers: List[List[Tuple[str, str]]],
+                      entries: List[Tuple[str, str]], data: List[int],
+                      bitmap_nodes: bool, minimize: bool, packed_strings: bool,
+                      layer_masks: Dict[str, int]) -> None:
+  """Prints the flash used by the layers, against separate dictionaries."""
+
+  def size(entries: List[Tuple[str, str]]) -> int:
+    return len(serialize_trie(entries, make_trie(entries), bitmap_nodes,
+                              minimize, packed_strings))
+
+  sizes = [size(expand_word_breaks(layer)) for layer in layers]
+  unmasked_size = size(entries)
+  print(f'Merged {len(layers)} layers ('
+        + ' + '.join(str(len(layer)) for layer in layers)
+        + f' entries) into {len(data)} bytes, vs. '
+        + ' + '.join(map(str, sizes))
+        + f' = {sum(sizes)} bytes for the dictionaries built separately, '
+        f'saving {sum(sizes) - len(data)} bytes. The layer masks cost '
+        f'{len(data) - unmasked_size} bytes.')
+  for i, f in enumerate(file_names):
+    only = sum(layer_masks[typo] == 1 << i for typo, _ in layers[i])
+    print(f'  Layer {i} (mask {1 << i}): {f}, {len(layers[i])} entries, '
+          f'{only} only in this layer.')
+
+
+def print_identifier_cost(autocorrections: List[Tuple[str, str]],
+                          entries: List[Tuple[str, str]], data: List[int],
+                          automaton: bool, bitmap_nodes: bool,
+                          minimize: bool, packed_strings: bool,
+                          layer_masks: Optional[Dict[str, int]] = None
+                          ) -> None:
+  """Prints the flash used for the typos with identifier symbols."""
+
+  def size(entries: List[Tuple[str, str]]) -> int:
+    if not entries:
+      return 0
+    elif automaton:
+      return len(make_automaton(entries, packed_strings))
+    return len(serialize_trie(entries, make_trie(entries), bitmap_nodes,
+                              minimize, packed_strings, layer_masks))
+
+  plain = [(typo, correction) for typo, correction in autocorrections
+           if all(c in SYMBOLS for c in typo)]
+  n = len(autocorrections) - len(plain)
+  copies = len(entries) - len(autocorrections)
+  breaks = ', '.join(f"'{c}'" for c in BREAK_SYMBOLS)
+  unexpanded_size = size(autocorrections)
+  print(f'Identifier symbols: {n} typos use them, costing '
+        f'{unexpanded_size - size(plain)} bytes, and the {copies} copies of '
+        f'typos for word breaks {breaks} cost '
+        f'{len(data) - unexpanded_size} bytes.')
+
+
 def main(argv):
-  dict_file = argv[1] if len(argv) > 1 else 'autocorrection_dict.txt'
-  h_file = argv[2] if len(argv) > 2 else get_default_h_file(dict_file)
-
-  autocorrections = parse_file(dict_file)
-  trie = make_trie(autocorrections)
-  data = serialize_trie(autocorrections, trie)
-  print(f'Processed %d autocorrection entries to table with %d bytes.'
-        % (len(autocorrections), len(data)))
-  write_generated_code(autocorrections, data, h_file)
+  automaton = False
+  bitmap_nodes = False
+  minimize = True
+  packed_strings = False
+  quick_reject = False
+  jobs = 1
+  args = []
+  for arg in argv[1:]:
+    if arg == '--automaton':
+      automaton = True
+    elif arg == '--bitmap_nodes':
+      bitmap_nodes = True
+    elif arg == '--no_minimize':
+      minimize = False
+    elif arg == '--packed_strings':
+      packed_strings = True
+    elif arg == '--quick_reject':
+      quick_reject = True
+    elif arg.startswith('--jobs='):
+      jobs = int(arg.split('=', 1)[1])
+    elif arg.startswith('--'):
+      print(f'Invalid option: {arg}')
+      sys.exit(1)
+    else:
+      args.append(arg)
+
+  dict_files = (args[0] if args else 'autocorrection_dict.txt').split(',')
+  h_file = args[1] if len(args) > 1 else get_default_h_file(dict_files[0])
+
+  layer_files = layer_masks = None
+  if len(dict_files) > 1:
+    if automaton:
+      print('Error: Layered dictionaries are not supported with --automaton.')
+      sys.exit(1)
+    layer_files = dict_files
+    layers = [parse_file(f, jobs) for f in dict_files]
+    autocorrections, layer_masks = merge_layers(dict_files, layers)
+  else:
+    autocorrections = parse_file(dict_files[0], jobs)
+  entries = expand_word_breaks(autocorrections, layer_masks)
+  trie = make_trie(entries)
+  data = serialize_trie(entries, trie, bitmap_nodes, minimize, packed_strings,
+                        layer_masks)
+  verify_trie(entries, data, packed_strings, layer_masks)
+  if minimize and not automaton:
+    plain_size = len(serialize_trie(entries, trie, bitmap_nodes, False,
+                                    packed_strings, layer_masks))
+    print(f'Minimized the trie from {plain_size} to {len(data)} bytes, saving '
+          f'{plain_size - len(data)} bytes.')
+  if automaton:
+    trie_data = data
+    data = make_automaton(entries, packed_strings)
+    print_cost_comparison(entries, [('Trie', trie_data, False),
+                                    ('Automaton', data, True)])
+  elif bitmap_nodes:
+    trie_data = serialize_trie(entries, make_trie(entries), False, minimize,
+                               packed_strings, layer_masks)
+    print_cost_comparison(entries, [('Trie', trie_data, False),
+                                    ('Bitmap trie', data, False)])
+  if packed_strings:
+    unpacked_size = len(make_automaton(entries) if automaton else
+                        serialize_trie(entries, trie, bitmap_nodes, minimize,
+                                       layer_masks=layer_masks))
+    print(f'Packed the correction strings from {unpacked_size} to {len(data)} '
+          f'bytes, saving {unpacked_size - len(data)} bytes.')
+  if quick_reject and automaton:
+    print('Note: --quick_reject is not used with --automaton.')
+    quick_reject = False
+  elif quick_reject:
+    quick_reject = make_quick_reject(entries)
+    print_quick_reject_cost(entries, data, quick_reject)
+  if layer_masks:
+    print_layers_cost(dict_files, layers, entries, data, bitmap_nodes, minimize,
+                      packed_strings, layer_masks)
+  if entries is not autocorrections:
+    print_identifier_cost(autocorrections, entries, data, automaton,
+                          bitmap_nodes, minimize, packed_strings, layer_masks)
+
+  print(f'Processed %d autocorrection entries to %s with %d bytes.'
+        % (len(autocorrections), 'automaton' if automaton else 'table',
+           len(data)))
+  write_generated_code(autocorrections, data, h_file, automaton,
+                       bitmap_nodes and not automaton, packed_strings,
+                       quick_reject, layer_files, layer_masks)
 
 
 if __name__ == '__main__':
@@ -0,0 +1,112 @@
+# Copyright 2024 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Python program to make keycode_classes_data.h.
+
+This program generates the PROGMEM table of keycode classes used by
+keycode_classes.c, so that Caps Word, Sentence Case, Autocorrection, and
+Achordion classify a keycode with one table read rather than each with its own
+switch. The table covers the basic keycodes KC_NO to KC_SLSH, which is
+where all the classes are. Each entry is the OR of the KEYCODE_CLASS_* bits
+of keycode_classes.h. Run this program like
+
+$ python3 make_keycode_classes.py
+
+The output is written to "keycode_classes_data.h" in the same directory as
+this program. Or optionally specify the output .h file as an argument. To
+change which keycodes are in a class, edit CLASSES below and rerun.
+"""
+
+import os.path
+import sys
+from typing import List
+
+# Basic keycodes covered by the table, indexed by keycode.
+KEYCODES = (
+    ['KC_NO', 'KC_TRNS', None, None]
+    + [f'KC_{c}' for c in 'ABCDEFGHIJKLMNOPQRSTUVWXYZ1234567890']
+    + ['KC_ENT', 'KC_ESC', 'KC_BSPC', 'KC_TAB', 'KC_SPC', 'KC_MINS', 'KC_EQL',
+       'KC_LBRC', 'KC_RBRC', 'KC_BSLS', 'KC_NUHS', 'KC_SCLN', 'KC_QUOT',
+       'KC_GRV', 'KC_COMM', 'KC_DOT', 'KC_SLSH'])
+
+LETTERS = [f'KC_{c}' for c in 'ABCDEFGHIJKLMNOPQRSTUVWXYZ']
+DIGITS = [f'KC_{c}' for c in '1234567890']
+SYMBOLS = ['KC_MINS', 'KC_EQL', 'KC_LBRC', 'KC_RBRC', 'KC_BSLS', 'KC_NUHS',
+           'KC_SCLN', 'KC_QUOT', 'KC_GRV', 'KC_COMM', 'KC_DOT', 'KC_SLSH']
+
+# Keycodes in each class. The class bits are 1, 2, 4, ... in this order, which
+# must match the KEYCODE_CLASS_* enum in keycode_classes.h.
+CLASSES = {
+    'LETTER': LETTERS,
+    'DIGIT': DIGITS,
+    'SYMBOL': SYMBOLS,
+    # Sentence-ending punctuation: '.' unshifted, '!' and '?' shifted.
+    'SENTENCE_END': ['KC_DOT'],
+    'SENTENCE_END_SHIFTED': ['KC_1', 'KC_SLSH'],
+    'WORD_BREAK': DIGITS + ['KC_ENT', 'KC_TAB', 'KC_SPC'] + SYMBOLS,
+    # Keys that Caps Word shifts.
+    'SHIFTABLE': LETTERS + ['KC_MINS'],
+}
+
+
+def make_table() -> List[int]:
+  """Makes the table of the class bits of each keycode."""
+  for name, keycodes in CLASSES.items():
+    for keycode in keycodes:
+      if keycode not in KEYCODES:
+        print(f'Error: {name} has {keycode}, which is not in the table.')
+        sys.exit(1)
+  return [sum(1 << i for i, keycodes in enumerate(CLASSES.values())
+              if keycode in keycodes) for keycode in KEYCODES]
+
+
+def write_generated_code(table: List[int], file_name: str) -> None:
+  """Writes the table as generated C code to `file_name`."""
+
+  def class_names(bits: int) -> str:
+    return ' '.join(name for i, name in enumerate(CLASSES) if bits >> i & 1)
+
+  generated_code = ''.join([
+    '// Generated code.\n\n',
+    '// Keycode classes:\n',
+    ''.join(f'//   {1 << i:>3}  KEYCODE_CLASS_{name}\n'
+            for i, name in enumerate(CLASSES)),
+    f'\n#define KEYCODE_CLASS_TABLE_SIZE {len(table)}\n\n',
+    'static const uint8_t keycode_class_table[KEYCODE_CLASS_TABLE_SIZE] '
+    'PROGMEM = {\n',
+    ''.join(f'  {bits:>3},  // {keycode or hex(i):<8}{class_names(bits)}'
+            .rstrip() + '\n'
+            for i, (keycode, bits) in enumerate(zip(KEYCODES, table))),
+    '};\n',
+  ])
+
+  with open(file_name, 'wt') as f:
+    f.write(generated_code)
+
+
+def get_default_h_file() -> str:
+  return os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                      'keycode_classes_data.h')
+
+
+def main(argv):
+  h_file = argv[1] if len(argv) > 1 else get_default_h_file()
+  table = make_table()
+  print(f'Processed {len(CLASSES)} classes to a table with {len(table)} '
+        'bytes.')
+  write_generated_code(table, h_file)
+
+
+if __name__ == '__main__':
+  main(sys.argv)
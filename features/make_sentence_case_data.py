@@ -0,0 +1,368 @@
+# Copyright 2024 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Python program to make sentence_case_data.h.
+
+This program generates a C header "sentence_case_data.h" with the tables that
+drive Sentence Case, from two files:
+
+ * A list of abbreviations, like "vs." and "Dr.", that Sentence Case should not
+   consider to end a sentence. They are stored as a trie of their keycodes in
+   reverse. The default `sentence_case_check_ending()` walks the trie once
+   backwards from the last key typed, so that checking for an abbreviation
+   costs about the same however many are listed.
+
+ * The state machine, as a matrix of the next state for each state and key
+   class. It is stored as a PROGMEM transition table, so that Sentence Case
+   steps with one table read per key.
+
+Run this program like
+
+$ python3 make_sentence_case_data.py sentence_case_abbreviations.txt
+
+The output is written to "sentence_case_data.h" in the same directory as the
+abbreviations file. Or optionally specify the output .h file as a second
+argument. Without arguments, sentence_case_abbreviations.txt in the same
+directory as this program is used. The state machine is read from
+sentence_case_states.txt in the directory of the abbreviations file, if there
+is one, or else of this program. Or specify it with `--states=FILE`.
+
+The abbreviations file has one abbreviation per line, ending in '.' and
+otherwise with only the characters a-z and '. Case is ignored. Blank lines and
+lines starting with '#' are ignored. Abbreviations with a '.' within, like
+"e.g.", are already detected by Sentence Case and are skipped.
+
+For the state machine syntax, see sentence_case_states.txt. For instance, to
+treat ')' after a sentence ending like a quote, return ')' for KC_RPRN from
+`sentence_case_press_user()` and add a ')' column to the matrix.
+
+For full documentation, see
+https://getreuer.info/posts/keyboards/sentence-case
+"""
+
+import os.path
+import sys
+import textwrap
+from typing import Any, Dict, List, Tuple
+
+# Keycodes of the characters allowed in abbreviations.
+KEYCODES = {chr(c + ord('a')): c + 0x04 for c in range(26)}
+KEYCODES["'"] = 0x34  # KC_QUOT
+KEYCODES['.'] = 0x37  # KC_DOT
+
+# Node header bits. The low 6 bits are the number of children.
+MATCH_BIT = 128  # An abbreviation ends at this node.
+CHAIN_BIT = 64  # The node has one child, stored inline.
+
+# Transition flags, which must match TRANSITION_* in sentence_case.c. The low 4
+# bits of a transition are the next state.
+TRANSITION_FLAGS = {
+    '?': 16,  # Check the ending.
+    '^': 32,  # Capitalize.
+    '!': 64,  # Forget the key last capitalized.
+}
+MAX_STATES = 15  # One more state, DISABLED, is added at runtime.
+# Entry of the class index for codes that are not a key class.
+NO_CLASS = 255
+
+
+def parse_file(file_name: str) -> List[str]:
+  """Parses the abbreviations file.
+
+  Args:
+    file_name: String, path of the abbreviations file.
+  Returns:
+    List of lowercase abbreviations.
+  """
+
+  abbreviations = []
+  line_number = 0
+  for line in open(file_name, 'rt'):
+    line_number += 1
+    line = line.strip()
+    if not line or line[0] == '#':
+      continue
+
+    abbreviation = line.lower()
+    if not all(c in KEYCODES for c in abbreviation):
+      print(f'Error:{line_number}: Abbreviation "{line}" has characters other '
+            'than ' + ''.join(KEYCODES))
+      sys.exit(1)
+    if len(abbreviation) < 2 or abbreviation[-1] != '.':
+      print(f'Error:{line_number}: Abbreviation "{line}" must end in \'.\'.')
+      sys.exit(1)
+    if '.' in abbreviation[:-1]:
+      print(f'Note:{line_number}: Skipping "{line}", which Sentence Case '
+            'already detects by its inner \'.\'.')
+      continue
+    if abbreviation in abbreviations:
+      print(f'Warning:{line_number}: Ignoring duplicate abbreviation: '
+            f'"{line}"')
+      continue
+
+    abbreviations.append(abbreviation)
+
+  return abbreviations
+
+
+def make_trie(abbreviations: List[str]) -> Dict[Any, Any]:
+  """Makes a trie of the abbreviations, keyed by keycode in reverse order.
+
+  The key None marks the end of an abbreviation.
+  """
+  trie = {}
+  for abbreviation in abbreviations:
+    node = trie
+    for c in reversed(abbreviation):
+      node = node.setdefault(KEYCODES[c], {})
+    node[None] = None
+  return trie
+
+
+def serialize_trie(trie: Dict[Any, Any]) -> List[int]:
+  """Serializes the trie as a byte array.
+
+  Nodes are written depth first from the root at offset 0. Each node begins
+  with a header byte. If MATCH_BIT is set, an abbreviation ends at the node. If
+  CHAIN_BIT is set, the node has one child, whose keycode is the next byte and
+  whose node follows. Otherwise the low 6 bits are the number of children,
+  followed by a 3-byte entry for each: the keycode, then the child's offset as a
+  16-bit little endian value.
+  """
+  data = []
+
+  def traverse(node: Dict[Any, Any]) -> None:
+    header = MATCH_BIT if None in node else 0
+    children = sorted(key for key in node if key is not None)
+    if len(children) == 1:
+      data.extend([header | CHAIN_BIT, children[0]])
+      traverse(node[children[0]])
+      return
+
+    data.append(header | len(children))
+    table = len(data)
+    data.extend([0] * (3 * len(children)))
+    for i, key in enumerate(children):
+      offset = len(data)
+      data[table + 3 * i:table + 3 * i + 3] = [key, offset & 255, offset >> 8]
+      traverse(node[key])
+
+  traverse(trie)
+  if len(data) > 0xffff:
+    print(f'Error: The trie is too large: {len(data)} bytes.')
+    sys.exit(1)
+  return data
+
+
+def is_abbreviation(data: List[int], keys: List[int]) -> bool:
+  """Matches `keys` as sentence_case.c does, with the last key typed last."""
+  state = 0
+  for i in range(len(keys)):
+    node = data[state]
+    key = keys[-1 - i]
+    if node & MATCH_BIT and not (KEYCODES['a'] <= key <= KEYCODES['z']):
+      return True
+    state += 1
+    if node & CHAIN_BIT:
+      if data[state] != key:
+        return False
+      state += 1
+    else:
+      for j in range(node & 63):
+        if data[state + 3 * j] == key:
+          state = data[state + 3 * j + 1] | data[state + 3 * j + 2] << 8
+          break
+      else:
+        return False
+  return False
+
+
+def verify_trie(abbreviations: List[str], data: List[int]) -> None:
+  """Checks that the trie matches each abbreviation after a word break."""
+  space = 0x2c  # KC_SPC
+  for abbreviation in abbreviations:
+    keys = [KEYCODES[c] for c in abbreviation]
+    if not is_abbreviation(data, [space] + keys):
+      print(f'Internal error: The trie does not match "{abbreviation}".')
+      sys.exit(1)
+    extended = 'x' + abbreviation
+    if (extended not in abbreviations and
+        is_abbreviation(data, [space, KEYCODES['x']] + keys)):
+      print(f'Internal error: The trie matches "{extended}".')
+      sys.exit(1)
+
+
+def parse_states_file(file_name: str) -> Tuple[str, List[str], List[int],
+                                               List[List[str]]]:
+  """Parses the state machine file.
+
+  Args:
+    file_name: String, path of the state machine file.
+  Returns:
+    (classes, states, transitions, matrix), where classes is a string of the
+    key class codes, states the state names, transitions the transition table
+    in row-major order, and matrix the entries as written.
+  """
+
+  rows = []
+  for line_number, line in enumerate(open(file_name, 'rt'), 1):
+    line = line.strip()
+    if line and line[0] != '#':
+      rows.append((line_number, line.split()))
+  if not rows:
+    print(f'Error: No key classes in {file_name}.')
+    sys.exit(1)
+
+  line_number, tokens = rows[0]
+  classes = ''.join(' ' if token == 'space' else token for token in tokens)
+  if len(classes) != len(tokens) or not all(' ' <= c <= '~' for c in classes):
+    print(f'Error:{line_number}: Key classes must be single printable ASCII '
+          'characters or "space".')
+    sys.exit(1)
+  if len(set(classes)) != len(classes):
+    print(f'Error:{line_number}: Duplicate key class.')
+    sys.exit(1)
+
+  states = [tokens[0] for _, tokens in rows[1:]]
+  for required in ('INIT', 'PRIMED'):
+    if required not in states:
+      print(f'Error: The state machine must have a {required} state.')
+      sys.exit(1)
+  if len(states) > MAX_STATES or 'DISABLED' in states:
+    print(f'Error: At most {MAX_STATES} states are supported, besides '
+          'DISABLED.')
+    sys.exit(1)
+
+  transitions = []
+  matrix = []
+  for line_number, tokens in rows[1:]:
+    if states.count(tokens[0]) > 1:
+      print(f'Error:{line_number}: Duplicate state {tokens[0]}.')
+      sys.exit(1)
+    if len(tokens) != len(classes) + 1:
+      print(f'Error:{line_number}: Expected a next state for each of the '
+            f'{len(classes)} key classes.')
+      sys.exit(1)
+    for entry in tokens[1:]:
+      name = entry.rstrip(''.join(TRANSITION_FLAGS))
+      if name not in states:
+        print(f'Error:{line_number}: Invalid next state "{entry}".')
+        sys.exit(1)
+      flags = set(entry[len(name):])
+      transitions.append(states.index(name) |
+                         sum(TRANSITION_FLAGS[c] for c in flags))
+    matrix.append(tokens)
+
+  return classes, states, transitions, matrix
+
+
+def write_generated_code(abbreviations: List[str], data: List[int],
+                         classes: str, states: List[str],
+                         transitions: List[int], matrix: List[List[str]],
+                         file_name: str) -> None:
+  """Writes the trie and state machine as generated C code to `file_name`."""
+  longest = max(abbreviations, key=len, default='')
+  # Column of each code from the lowest to the highest class code, so that the
+  # class of a code is a direct lookup.
+  first = min(map(ord, classes))
+  last = max(map(ord, classes))
+  class_index = [classes.index(chr(c)) if chr(c) in classes else NO_CLASS
+                 for c in range(first, last + 1)]
+  header = [''] + ['space' if c == ' ' else c for c in classes]
+  width = max(len(token) for row in [header] + matrix for token in row) + 2
+  generated_code = ''.join([
+    '// Generated code.\n\n',
+    f'// Sentence Case abbreviations ({len(abbreviations)} entries):\n',
+    ''.join(f'//   {abbreviation}\n' for abbreviation in sorted(abbreviations)),
+    f'\n#define SENTENCE_CASE_ABBREVIATIONS_MAX_LENGTH {len(longest)}'
+    + (f'  // "{longest}"' if longest else ''),
+    '\n\n',
+    textwrap.fill('static const uint8_t sentence_case_abbreviations[%d] '
+                  'PROGMEM = {%s};' % (len(data), ', '.join(map(str, data))),
+                  width=80, subsequent_indent='  '),
+    '\n\n',
+    '// Sentence Case state machine:\n',
+    ''.join('//  ' + ''.join(f'{token:<{width}}' for token in row).rstrip()
+            + '\n' for row in [header] + matrix),
+    '\nenum {\n',
+    ''.join(f'  STATE_{name},\n' for name in states),
+    '  STATE_DISABLED,\n};\n\n',
+    '#define SENTENCE_CASE_STATE_NAMES \\\n  ',
+    ', '.join(f'"{name}"' for name in states + ['DISABLED']),
+    f'\n#define SENTENCE_CASE_NUM_CLASSES {len(classes)}\n',
+    f'#define SENTENCE_CASE_CLASS_FIRST {first}  // {chr(first)!r}\n',
+    f'#define SENTENCE_CASE_CLASS_LAST {last}  // {chr(last)!r}\n',
+    f'#define SENTENCE_CASE_NO_CLASS {NO_CLASS}\n\n',
+    textwrap.fill('static const uint8_t sentence_case_class_index[%d] '
+                  'PROGMEM = {%s};' % (len(class_index),
+                                       ', '.join(map(str, class_index))),
+                  width=80, subsequent_indent='  '),
+    '\n\n',
+    textwrap.fill('static const uint8_t sentence_case_transitions[%d] '
+                  'PROGMEM = {%s};' % (len(transitions),
+                                       ', '.join(map(str, transitions))),
+                  width=80, subsequent_indent='  '),
+    '\n',
+  ])
+
+  with open(file_name, 'wt') as f:
+    f.write(generated_code)
+
+
+def get_default_h_file(abbreviations_file: str) -> str:
+  return os.path.join(os.path.dirname(abbreviations_file),
+                      'sentence_case_data.h')
+
+
+def get_default_states_file(abbreviations_file: str) -> str:
+  states_file = os.path.join(os.path.dirname(abbreviations_file),
+                             'sentence_case_states.txt')
+  if os.path.exists(states_file):
+    return states_file
+  return os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                      'sentence_case_states.txt')
+
+
+def main(argv):
+  states_file = None
+  args = []
+  for arg in argv[1:]:
+    if arg.startswith('--states='):
+      states_file = arg.split('=', 1)[1]
+    elif arg.startswith('--'):
+      print(f'Invalid option: {arg}')
+      sys.exit(1)
+    else:
+      args.append(arg)
+
+  abbreviations_file = args[0] if args else os.path.join(
+      os.path.dirname(os.path.abspath(__file__)),
+      'sentence_case_abbreviations.txt')
+  h_file = args[1] if len(args) > 1 else get_default_h_file(abbreviations_file)
+  states_file = states_file or get_default_states_file(abbreviations_file)
+
+  abbreviations = parse_file(abbreviations_file)
+  data = serialize_trie(make_trie(abbreviations))
+  verify_trie(abbreviations, data)
+  print(f'Processed {len(abbreviations)} abbreviations to a trie with '
+        f'{len(data)} bytes.')
+  classes, states, transitions, matrix = parse_states_file(states_file)
+  print(f'Processed {len(states)} states and {len(classes)} key classes to a '
+        f'transition table with {len(transitions)} bytes.')
+  write_generated_code(abbreviations, data, classes, states, transitions,
+                       matrix, h_file)
+
+
+if __name__ == '__main__':
+  main(sys.argv)
@@ -24,6 +24,9 @@
 
 #include <string.h>
 
+#include "keycode_classes.h"
+#include "sentence_case_data.h"
+
 #if !defined(IS_QK_MOD_TAP)
 // Attempt to detect out-of-date QMK installation, which would fail with
 // implicit-function-declaration errors in the code below.
@@ -35,28 +38,36 @@
 #error "sentence_case: Please enable oneshot."
 #else
 
+#if SENTENCE_CASE_BUFFER_SIZE > 1 && \
+    SENTENCE_CASE_BUFFER_SIZE <= SENTENCE_CASE_ABBREVIATIONS_MAX_LENGTH
+// An abbreviation is matched together with the key before it.
+#pragma message \
+    "sentence_case: SENTENCE_CASE_BUFFER_SIZE is too small for some " \
+    "abbreviations."
+#endif
+
 // Number of keys of state history to retain for backspacing.
 #define STATE_HISTORY_SIZE 6
 
-// clang-format off
-/** States in matching the beginning of a sentence. */
-enum {
-  STATE_INIT,     /**< Initial enabled state. */
-  STATE_WORD,     /**< Within a word. */
-  STATE_ABBREV,   /**< Within an abbreviation like "e.g.". */
-  STATE_ENDING,   /**< Sentence ended. */
-  STATE_PRIMED,   /**< "Primed" state, in the space following an ending. */
-  STATE_DISABLED, /**< Sentence Case is disabled. */
-};
-// clang-format on
+// The states, STATE_INIT, STATE_PRIMED, etc., are defined in
+// sentence_case_data.h from sentence_case_states.txt, followed by
+// STATE_DISABLED when Sentence Case is disabled. An entry of the transition
+// table has the next state in the low 4 bits, and these flags, which must
+// match make_sentence_case_data.py.
+#define TRANSITION_STATE_MASK 15
+#define TRANSITION_CHECK 16  // Check the ending.
+#define TRANSITION_CAPITALIZE 32  // Capitalize the key.
+#define TRANSITION_FORGET 64  // Forget the key last capitalized.
 
 #if SENTENCE_CASE_TIMEOUT > 0
 static uint16_t idle_timer = 0;
 #endif  // SENTENCE_CASE_TIMEOUT > 0
 #if SENTENCE_CASE_BUFFER_SIZE > 1
-static uint16_t key_buffer[SENTENCE_CASE_BUFFER_SIZE] = {0};
+static sentence_case_buffer_t key_buffer = {{0}, 0};
 #endif  // SENTENCE_CASE_BUFFER_SIZE > 1
+// Ring of the states before each of the last keys, like `key_buffer`.
 static uint8_t state_history[STATE_HISTORY_SIZE];
+static uint8_t state_history_end = 0;
 static uint16_t suppress_key = KC_NO;
 static uint8_t sentence_state = STATE_INIT;
 
@@ -64,9 +75,7 @@ static uint8_t sentence_state = STATE_INIT;
 static void set_sentence_state(uint8_t new_state) {
 #if !defined(NO_DEBUG) && defined(SENTENCE_CASE_DEBUG)
   if (debug_enable && sentence_state != new_state) {
-    static const char* state_names[] = {
-        "INIT", "WORD", "ABBREV", "ENDING", "PRIMED", "DISABLED",
-    };
+    static const char* state_names[] = {SENTENCE_CASE_STATE_NAMES};
     dprintf("Sentence case: %s\n", state_names[new_state]);
   }
 #endif  // !NO_DEBUG && SENTENCE_CASE_DEBUG
@@ -78,6 +87,20 @@ static void set_sentence_state(uint8_t new_state) {
   sentence_state = new_state;
 }
 
+// Steps ring index `i` forward or back in a ring of size `n`.
+#define RING_NEXT(i, n) ((i) + 1 < (n) ? (i) + 1 : 0)
+#define RING_PREV(i, n) ((i) ? (i) - 1 : (n) - 1)
+
+#if SENTENCE_CASE_BUFFER_SIZE > 1
+// Appends `keycode` to `key_buffer`. Optimization note: Keeping this out of
+// line saved ~150 bytes on x86 with -Os, where inlining copied it into every
+// branch of process_sentence_case().
+static void __attribute__((noinline)) append_key(uint16_t keycode) {
+  key_buffer.keys[key_buffer.end] = keycode;
+  key_buffer.end = RING_NEXT(key_buffer.end, SENTENCE_CASE_BUFFER_SIZE);
+}
+#endif  // SENTENCE_CASE_BUFFER_SIZE > 1
+
 static void clear_state_history(void) {
 #if SENTENCE_CASE_TIMEOUT > 0
   idle_timer = 0;
@@ -92,7 +115,7 @@ void sentence_case_clear(void) {
   clear_state_history();
   suppress_key = KC_NO;
 #if SENTENCE_CASE_BUFFER_SIZE > 1
-  memset(key_buffer, 0, sizeof(key_buffer));
+  memset(key_buffer.keys, 0, sizeof(key_buffer.keys));
 #endif  // SENTENCE_CASE_BUFFER_SIZE > 1
 }
 
@@ -186,123 +209,85 @@ bool process_sentence_case(uint16_t keycode, keyrecord_t* record) {
   }
 
   if (keycode == KC_BSPC) {
-    // Backspace key pressed. Rewind the state and key buffers.
-    set_sentence_state(state_history[STATE_HISTORY_SIZE - 1]);
-
-    memmove(state_history + 1, state_history, STATE_HISTORY_SIZE - 1);
-    state_history[0] = STATE_INIT;
+    // Backspace key pressed. Rewind the state and key buffers. The freed slot
+    // becomes the oldest entry, which is cleared.
+    state_history_end = RING_PREV(state_history_end, STATE_HISTORY_SIZE);
+    set_sentence_state(state_history[state_history_end]);
+    state_history[state_history_end] = STATE_INIT;
 #if SENTENCE_CASE_BUFFER_SIZE > 1
-    memmove(key_buffer + 1, key_buffer,
-            (SENTENCE_CASE_BUFFER_SIZE - 1) * sizeof(uint16_t));
-    key_buffer[0] = KC_NO;
+    key_buffer.end = RING_PREV(key_buffer.end, SENTENCE_CASE_BUFFER_SIZE);
+    key_buffer.keys[key_buffer.end] = KC_NO;
 #endif  // SENTENCE_CASE_BUFFER_SIZE > 1
     return true;
   }
 
   const uint8_t mods = get_mods() | get_weak_mods() | get_oneshot_mods();
-  uint8_t new_state = STATE_INIT;
-
-  // We search for sentence beginnings using a simple finite state machine. It
-  // matches things like "a. a" and "a.  a" but not "a.. a" or "a.a. a". The
-  // state transition matrix is:
-  //
-  //             'a'       '.'      ' '      '\''
-  //           +-------------------------------------
-  //   INIT    | WORD      INIT     INIT     INIT
-  //   WORD    | WORD      ENDING   INIT     WORD
-  //   ABBREV  | ABBREV    ABBREV   INIT     ABBREV
-  //   ENDING  | ABBREV    INIT     PRIMED   ENDING
-  //   PRIMED  | match!    INIT     PRIMED   PRIMED
-  char code = sentence_case_press_user(keycode, record, mods);
+
+  // We search for sentence beginnings using a simple finite state machine, with
+  // the transition table generated from sentence_case_states.txt. It matches
+  // things like "a. a" and "a.  a" but not "a.. a" or "a.a. a".
+  const char code = sentence_case_press_user(keycode, record, mods);
 #if defined SENTENCE_CASE_DEBUG
   dprintf("Sentence Case: code = '%c' (%d)\n", code, (int)code);
 #endif  // SENTENCE_CASE_DEBUG
-  switch (code) {
-    case '\0':  // Current key should be ignored.
-      return true;
-
-    case 'a':  // Current key is a letter.
-      switch (sentence_state) {
-        case STATE_ABBREV:
-        case STATE_ENDING:
-          new_state = STATE_ABBREV;
-          break;
-
-        case STATE_PRIMED:
-          // This is the start of a sentence.
-          if (keycode != suppress_key) {
-            suppress_key = keycode;
-            set_oneshot_mods(MOD_BIT(KC_LSFT));  // Shift mod to capitalize.
-            new_state = STATE_WORD;
-          }
-          break;
-
-        default:
-          new_state = STATE_WORD;
-      }
-      break;
-
-    case '.':  // Current key is sentence-ending punctuation.
-      switch (sentence_state) {
-        case STATE_WORD:
-          new_state = STATE_ENDING;
-          break;
-
-        default:
-          new_state = STATE_ABBREV;
-      }
-      break;
-
-    case ' ':  // Current key is a space.
-      if (sentence_state == STATE_PRIMED ||
-          (sentence_state == STATE_ENDING
-#if SENTENCE_CASE_BUFFER_SIZE > 1
-           && sentence_case_check_ending(key_buffer)
-#endif  // SENTENCE_CASE_BUFFER_SIZE > 1
-               )) {
-        new_state = STATE_PRIMED;
-        suppress_key = KC_NO;
-      }
-      break;
-
-    case '\'':  // Current key is a quote.
-      new_state = sentence_state;
-      break;
+  if (code == '\0') {  // Current key should be ignored.
+    return true;
   }
 
-    // Slide key_buffer and state_history buffers one element to the left.
-    // Optimization note: Using manual loops instead of memmove() here saved
-    // ~100 bytes on AVR.
-#if SENTENCE_CASE_BUFFER_SIZE > 1
-  for (int8_t i = 0; i < SENTENCE_CASE_BUFFER_SIZE - 1; ++i) {
-    key_buffer[i] = key_buffer[i + 1];
+  // Look up the key class of `code`. Unlisted codes go to STATE_INIT.
+  const uint8_t i = (uint8_t)code - SENTENCE_CASE_CLASS_FIRST;
+  const uint8_t key_class =
+      (i <= SENTENCE_CASE_CLASS_LAST - SENTENCE_CASE_CLASS_FIRST)
+          ? pgm_read_byte(sentence_case_class_index + i)
+          : SENTENCE_CASE_NO_CLASS;
+  const uint8_t transition =
+      (key_class != SENTENCE_CASE_NO_CLASS)
+          ? pgm_read_byte(sentence_case_transitions +
+                          sentence_state * SENTENCE_CASE_NUM_CLASSES +
+                          key_class)
+          : STATE_INIT;
+  uint8_t new_state = transition & TRANSITION_STATE_MASK;
+
+  if (transition & TRANSITION_CAPITALIZE) {
+    // This is the start of a sentence.
+    if (keycode != suppress_key) {
+      suppress_key = keycode;
+      set_oneshot_mods(MOD_BIT(KC_LSFT));  // Shift mod to capitalize.
+    } else {
+      new_state = STATE_INIT;
+    }
   }
-#endif  // SENTENCE_CASE_BUFFER_SIZE > 1
-  for (int8_t i = 0; i < STATE_HISTORY_SIZE - 1; ++i) {
-    state_history[i] = state_history[i + 1];
+  if (transition & TRANSITION_FORGET) {
+    suppress_key = KC_NO;
   }
 
+  // Append the key and the previous state to the rings, overwriting the
+  // oldest entries.
 #if SENTENCE_CASE_BUFFER_SIZE > 1
-  key_buffer[SENTENCE_CASE_BUFFER_SIZE - 1] = keycode;
-  if (new_state == STATE_ENDING && !sentence_case_check_ending(key_buffer)) {
+  append_key(keycode);
+  if ((transition & TRANSITION_CHECK) &&
+      !sentence_case_check_ending(&key_buffer)) {
 #if defined SENTENCE_CASE_DEBUG
     dprintf("Not a real ending.\n");
 #endif  // SENTENCE_CASE_DEBUG
     new_state = STATE_INIT;
   }
 #endif  // SENTENCE_CASE_BUFFER_SIZE > 1
-  state_history[STATE_HISTORY_SIZE - 1] = sentence_state;
+  state_history[state_history_end] = sentence_state;
+  state_history_end = RING_NEXT(state_history_end, STATE_HISTORY_SIZE);
 
   set_sentence_state(new_state);
   return true;
 }
 
-bool sentence_case_just_typed_P(const uint16_t* buffer, const uint16_t* pattern,
-                                int8_t pattern_len) {
+bool sentence_case_just_typed_P(const sentence_case_buffer_t* buffer,
+                                const uint16_t* pattern, int8_t pattern_len) {
 #if SENTENCE_CASE_BUFFER_SIZE > 1
-  buffer += SENTENCE_CASE_BUFFER_SIZE - pattern_len;
-  for (int8_t i = 0; i < pattern_len; ++i) {
-    if (buffer[i] != pgm_read_word(pattern + i)) {
+  // Compare backwards from the last key typed.
+  uint8_t j = buffer->end;
+  for (int8_t i = pattern_len - 1; i >= 0; --i) {
+    j = RING_PREV(j, SENTENCE_CASE_BUFFER_SIZE);
+    if (buffer->keys[j] != pgm_read_word(pattern + i)) {
       return false;
     }
   }
@@ -312,14 +297,53 @@ bool sentence_case_just_typed_P(const uint16_t* buffer, const uint16_t* pattern,
 #endif  // SENTENCE_CASE_BUFFER_SIZE > 1
 }
 
-__attribute__((weak)) bool sentence_case_check_ending(const uint16_t* buffer) {
-#if SENTENCE_CASE_BUFFER_SIZE >= 5
-  // Don't consider the abbreviations "vs." and "etc." to end the sentence.
-  if (SENTENCE_CASE_JUST_TYPED(KC_SPC, KC_V, KC_S, KC_DOT) ||
-      SENTENCE_CASE_JUST_TYPED(KC_SPC, KC_E, KC_T, KC_C, KC_DOT)) {
+bool sentence_case_is_abbreviation(const sentence_case_buffer_t* buffer) {
+#if SENTENCE_CASE_BUFFER_SIZE > 1
+  // Walk the trie of the abbreviations in reverse, from the last key typed.
+  // Each node starts with a header byte: bit 128 means an abbreviation ends at
+  // the node, which matches if the key before it is not a letter. Bit 64 means
+  // the node has one child, whose keycode is the next byte and whose node
+  // follows. Otherwise the low 6 bits are the number of children, each with a
+  // 3-byte entry of the keycode and the child's 16-bit offset.
+  uint16_t state = 0;
+  uint8_t j = buffer->end;
+  for (uint8_t i = 0; i < SENTENCE_CASE_BUFFER_SIZE; ++i) {
+    const uint8_t node = pgm_read_byte(sentence_case_abbreviations + state);
+    j = RING_PREV(j, SENTENCE_CASE_BUFFER_SIZE);
+    const uint16_t key = buffer->keys[j];
+    if ((node & 128) && !(keycode_classes(key) & KEYCODE_CLASS_LETTER)) {
+      return true;
+    }
+    ++state;
+    if (node & 64) {  // Chain: one child.
+      if (pgm_read_byte(sentence_case_abbreviations + state) != key) {
+        return false;
+      }
+      ++state;
+    } else {  // Search the children for `key`.
+      uint8_t n = node & 63;
+      for (; n && pgm_read_byte(sentence_case_abbreviations + state) != key;
+           --n) {
+        state += 3;
+      }
+      if (!n) {
+        return false;
+      }
+      state = pgm_read_byte(sentence_case_abbreviations + state + 1) |
+              (uint16_t)pgm_read_byte(sentence_case_abbreviations + state + 2)
+                  << 8;
+    }
+  }
+#endif  // SENTENCE_CASE_BUFFER_SIZE > 1
+  return false;
+}
+
+__attribute__((weak)) bool sentence_case_check_ending(
+    const sentence_case_buffer_t* buffer) {
+  // Don't consider abbreviations like "vs." and "etc." to end the sentence.
+  if (sentence_case_is_abbreviation(buffer)) {
     return false;  // Not a real sentence ending.
   }
-#endif  // SENTENCE_CASE_BUFFER_SIZE >= 5
   return true;  // Real sentence ending; capitalize next letter.
 }
 
@@ -328,24 +352,20 @@ __attribute__((weak)) char sentence_case_press_user(uint16_t keycode,
                                                     uint8_t mods) {
   if ((mods & ~(MOD_MASK_SHIFT | MOD_BIT(KC_RALT))) == 0) {
     const bool shifted = mods & MOD_MASK_SHIFT;
+    const uint8_t classes = keycode_classes(keycode);
+    if (classes & KEYCODE_CLASS_LETTER) {
+      return 'a';  // Letter key.
+    } else if (classes & (shifted ? KEYCODE_CLASS_SENTENCE_END_SHIFTED
+                                  : KEYCODE_CLASS_SENTENCE_END)) {
+      return '.';  // . or Shift 1 = ! or Shift / = ?
+    }
+
     switch (keycode) {
-      case KC_A ... KC_Z:
-        return 'a';  // Letter key.
-
-      case KC_DOT:  // . is punctuation, Shift . is a symbol (>)
-        return !shifted ? '.' : '#';
-      case KC_1:
-      case KC_SLSH:
-        return shifted ? '.' : '#';
       case KC_EXLM:
       case KC_QUES:
         return '.';
-      case KC_2 ... KC_0:  // 2 3 4 5 6 7 8 9 0
       case KC_AT ... KC_RPRN:  // @ # $ % ^ & * ( )
-      case KC_MINS ... KC_SCLN:  // - = [ ] backslash ;
       case KC_UNDS ... KC_COLN:  // _ + { } | :
-      case KC_GRV:
-      case KC_COMM:
         return '#';  // Symbol key.
 
       case KC_SPC:
@@ -354,6 +374,11 @@ __attribute__((weak)) char sentence_case_press_user(uint16_t keycode,
       case KC_QUOT:
         return '\'';  // Quote key.
     }
+
+    // Other digits and symbols, including Shift . = > and unshifted 1 and /.
+    if (classes & (KEYCODE_CLASS_DIGIT | KEYCODE_CLASS_SYMBOL)) {
+      return '#';  // Symbol key.
+    }
   }
 
   // Otherwise clear Sentence Case to initial state.
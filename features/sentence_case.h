@@ -33,11 +33,24 @@
  *   "a... a"
  *   "a.a. a"
  *
- * Additionally by default, abbreviations "vs." and "etc." are exceptionally
- * detected as not real sentence endings. You can use the callback
- * `sentence_case_check_ending()` to define other exceptions.
+ * Additionally by default, abbreviations like "vs.", "etc.", and "Dr." are
+ * exceptionally detected as not real sentence endings. These are listed in
+ * sentence_case_abbreviations.txt. To change them, edit the list and run
  *
- * @note One-shot keys must be enabled.
+ *     $ python3 make_sentence_case_data.py sentence_case_abbreviations.txt
+ *
+ * which generates sentence_case_data.h with the abbreviations as a trie of
+ * their keys in reverse. A sentence ending is checked with one walk back over
+ * the last keys typed, however many abbreviations are listed. Or use the
+ * callback `sentence_case_check_ending()` to define other exceptions.
+ *
+ * The state machine that finds sentence beginnings is likewise generated from
+ * sentence_case_states.txt, as a transition table stepped with one read per
+ * key. Edit it to change how keys are interpreted between sentences.
+ *
+ * @note One-shot keys must be enabled. Also add
+ * `SRC += features/keycode_classes.c` in rules.mk, which this uses to classify
+ * keycodes, and put sentence_case_data.h next to sentence_case.c.
  *
  * For full documentation, see
  * <https://getreuer.info/posts/keyboards/sentence-case>
@@ -53,11 +66,33 @@ extern "C" {
 
 // The size of the keycode buffer for `sentence_case_check_ending()`. It must be
 // at least as large as the longest pattern checked. If less than 2, buffering
-// is disabled and the callback is not called.
+// is disabled and the callback is not called. The buffer is a ring, so a larger
+// size costs RAM but no time per key.
 #ifndef SENTENCE_CASE_BUFFER_SIZE
 #define SENTENCE_CASE_BUFFER_SIZE 8
 #endif  // SENTENCE_CASE_BUFFER_SIZE
 
+/**
+ * Ring buffer of the last SENTENCE_CASE_BUFFER_SIZE keycodes, as passed to
+ * `sentence_case_check_ending()`. The last key typed is at index `end - 1`,
+ * wrapping around, and the oldest at `end`. Read it with
+ * `SENTENCE_CASE_JUST_TYPED()` or `sentence_case_recent_key()`.
+ */
+typedef struct {
+  uint16_t keys[SENTENCE_CASE_BUFFER_SIZE];
+  uint8_t end;
+} sentence_case_buffer_t;
+
+/**
+ * Gets the `i`th most recent keycode in `buffer`, where 0 is the last key
+ * typed. `i` must be less than SENTENCE_CASE_BUFFER_SIZE.
+ */
+static inline uint16_t sentence_case_recent_key(
+    const sentence_case_buffer_t* buffer, uint8_t i) {
+  return buffer->keys[(buffer->end > i ? 0 : SENTENCE_CASE_BUFFER_SIZE) +
+                      buffer->end - 1 - i];
+}
+
 /**
  * Handler function for Sentence Case.
  *
@@ -100,28 +135,44 @@ void sentence_case_primed(bool primed);
  * When a sentence-ending punctuation key is typed, this callback is called to
  * determine whether it is a real sentence ending, meaning the first letter of
  * the following word should be capitalized. For instance, abbreviations like
- * "vs." are usually not real sentence endings. The input argument is a buffer
- * of the last SENTENCE_CASE_BUFFER_SIZE keycodes. Returning true means it is a
- * real sentence ending; returning false means it is not.
+ * "vs." are usually not real sentence endings. The input argument is a ring
+ * buffer of the last SENTENCE_CASE_BUFFER_SIZE keycodes. Returning true means
+ * it is a real sentence ending; returning false means it is not.
  *
- * The default implementation checks for the abbreviations "vs." and "etc.":
+ * The default implementation checks for the abbreviations in
+ * sentence_case_data.h:
  *
- *     bool sentence_case_check_ending(const uint16_t* buffer) {
- *       // Don't consider "vs." and "etc." to end the sentence.
- *       if (SENTENCE_CASE_JUST_TYPED(KC_SPC, KC_V, KC_S, KC_DOT) ||
- *           SENTENCE_CASE_JUST_TYPED(KC_SPC, KC_E, KC_T, KC_C, KC_DOT)) {
+ *     bool sentence_case_check_ending(const sentence_case_buffer_t* buffer) {
+ *       // Don't consider abbreviations like "vs." and "etc." to end the
+ *       // sentence.
+ *       if (sentence_case_is_abbreviation(buffer)) {
  *         return false;  // Not a real sentence ending.
  *       }
  *       return true;  // Real sentence ending; capitalize next letter.
  *     }
  *
+ * Other patterns can be checked with `SENTENCE_CASE_JUST_TYPED()`, like
+ *
+ *     if (SENTENCE_CASE_JUST_TYPED(KC_SPC, KC_V, KC_S, KC_DOT)) { ... }
+ *
+ * Single keys can be checked with `sentence_case_recent_key(buffer, i)`.
+ *
  * @note This callback is used only if `SENTENCE_CASE_BUFFER_SIZE >= 2`.
  *       Otherwise it has no effect.
  *
- * @param buffer Buffer of the last `SENTENCE_CASE_BUFFER_SIZE` keycodes.
+ * @param buffer Ring buffer of the last `SENTENCE_CASE_BUFFER_SIZE` keycodes.
  * @return whether there is a real sentence ending.
  */
-bool sentence_case_check_ending(const uint16_t* buffer);
+bool sentence_case_check_ending(const sentence_case_buffer_t* buffer);
+
+/**
+ * Returns true if the last keys typed are an abbreviation of
+ * sentence_case_data.h, like " vs.", with a key besides a letter before it.
+ *
+ * @note Abbreviations are detected only if shorter than
+ *       `SENTENCE_CASE_BUFFER_SIZE`.
+ */
+bool sentence_case_is_abbreviation(const sentence_case_buffer_t* buffer);
 
 /**
  * Macro to be used in `sentence_case_check_ending()`.
@@ -141,8 +192,8 @@ bool sentence_case_check_ending(const uint16_t* buffer);
     sentence_case_just_typed_P(buffer, pattern,                     \
                                sizeof(pattern) / sizeof(uint16_t)); \
   })
-bool sentence_case_just_typed_P(const uint16_t* buffer, const uint16_t* pattern,
-                                int8_t pattern_len);
+bool sentence_case_just_typed_P(const sentence_case_buffer_t* buffer,
+                                const uint16_t* pattern, int8_t pattern_len);
 
 /**
  * Optional callback defining which keys are letter, punctuation, etc.
@@ -165,6 +216,12 @@ bool sentence_case_just_typed_P(const uint16_t* buffer, const uint16_t* pattern,
  *
  *  '\0'  Sentence Case should ignore this key.
  *
+ * Other codes reset Sentence Case to its initial state, unless they are added
+ * as key classes to the state machine in sentence_case_states.txt. E.g. to
+ * treat ')' after a sentence ending like a quote, return ')' for KC_RPRN, add a
+ * ')' column to sentence_case_states.txt, and rerun
+ * make_sentence_case_data.py to regenerate sentence_case_data.h.
+ *
  * If a hotkey or navigation key is pressed (or another key that performs an
  * action that backspace doesn't undo), then the callback should call
  * `sentence_case_clear()` to clear the state and then return '\0'.
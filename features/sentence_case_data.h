@@ -0,0 +1,62 @@
+// Generated code.
+
+// Sentence Case abbreviations (16 entries):
+//   approx.
+//   cf.
+//   dept.
+//   dr.
+//   esp.
+//   est.
+//   etc.
+//   fig.
+//   incl.
+//   mr.
+//   mrs.
+//   ms.
+//   prof.
+//   resp.
+//   st.
+//   vs.
+
+#define SENTENCE_CASE_ABBREVIATIONS_MAX_LENGTH 7  // "approx."
+
+static const uint8_t sentence_case_abbreviations[117] PROGMEM = {64, 55, 9, 6,
+  30, 0, 9, 35, 0, 10, 48, 0, 15, 53, 0, 19, 60, 0, 21, 67, 0, 22, 76, 0, 23,
+  91, 0, 27, 106, 0, 64, 23, 64, 8, 128, 2, 6, 42, 0, 18, 43, 0, 128, 64, 21,
+  64, 19, 128, 64, 12, 64, 9, 128, 64, 6, 64, 17, 64, 12, 128, 64, 22, 64, 8,
+  192, 21, 128, 2, 7, 74, 0, 16, 75, 0, 128, 128, 3, 16, 86, 0, 21, 87, 0, 25,
+  90, 0, 128, 64, 16, 128, 128, 2, 19, 98, 0, 22, 103, 0, 64, 8, 64, 7, 128,
+  192, 8, 128, 64, 18, 64, 21, 64, 19, 64, 19, 64, 4, 128};
+
+// Sentence Case state machine:
+//           a        .        #        space    '
+//  INIT     WORD     ABBREV   INIT     INIT     INIT
+//  WORD     WORD     ENDING?  INIT     INIT     WORD
+//  ABBREV   ABBREV   ABBREV   INIT     INIT     ABBREV
+//  ENDING   ABBREV   ABBREV   INIT     PRIMED!  ENDING?
+//  PRIMED   WORD^    ABBREV   INIT     PRIMED!  PRIMED
+
+enum {
+  STATE_INIT,
+  STATE_WORD,
+  STATE_ABBREV,
+  STATE_ENDING,
+  STATE_PRIMED,
+  STATE_DISABLED,
+};
+
+#define SENTENCE_CASE_STATE_NAMES \
+  "INIT", "WORD", "ABBREV", "ENDING", "PRIMED", "DISABLED"
+#define SENTENCE_CASE_NUM_CLASSES 5
+#define SENTENCE_CASE_CLASS_FIRST 32  // ' '
+#define SENTENCE_CASE_CLASS_LAST 97  // 'a'
+#define SENTENCE_CASE_NO_CLASS 255
+
+static const uint8_t sentence_case_class_index[66] PROGMEM = {3, 255, 255, 2,
+  255, 255, 255, 4, 255, 255, 255, 255, 255, 255, 1, 255, 255, 255, 255, 255,
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+  255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0};
+
+static const uint8_t sentence_case_transitions[25] PROGMEM = {1, 2, 0, 0, 0, 1,
+  19, 0, 0, 1, 2, 2, 0, 0, 2, 2, 2, 0, 68, 19, 33, 2, 0, 68, 4};
@@ -0,0 +1,227 @@
+# Copyright 2024 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Python program to upload an autocorrection dictionary to the keyboard.
+
+For a keyboard built with AUTOCORRECTION_UPLOAD, this program compiles an
+autocorrection dictionary like make_autocorrection_data.py and uploads it over
+raw HID, so that the dictionary is changed without reflashing. Run it on Linux
+like
+
+$ python3 upload_autocorrection_dict.py autocorrection_dict.txt
+
+Options:
+
+  --device=PATH  The hidraw device of the keyboard, e.g. /dev/hidraw3. By
+                 default, the first device with QMK's raw HID interface is
+                 used. Reading and writing it may need permission, e.g. a udev
+                 rule or sudo.
+  --sim=COMMAND  Instead of a keyboard, upload to the host stand-in built in
+                 tools/autocorrection_sim, run as COMMAND, e.g.
+                 --sim="tools/autocorrection_sim/device --eeprom=eeprom.bin".
+  --force        Upload even if the keyboard already has the dictionary.
+
+The dictionary is stored with a header that has the format version and a CRC,
+and the keyboard only uses it once the whole upload has been checked. See
+autocorrection.h for the format and protocol.
+
+For full documentation, see
+https://getreuer.info/posts/keyboards/autocorrection
+"""
+
+import glob
+import os.path
+import shlex
+import subprocess
+import sys
+from typing import List, Tuple
+
+import make_autocorrection_data as generator
+
+REPORT_SIZE = 32
+REPORT_ID = ord('C')
+# Usage page and usage of QMK's raw HID interface.
+RAW_HID_USAGE = bytes([0x06, 0x60, 0xff, 0x09, 0x61])
+
+# Format and protocol, as in autocorrection.h.
+FORMAT_VERSION = 1
+HEADER_SIZE = 8
+FLAG_BITMAP_NODES = 1
+FLAG_IDENTIFIERS = 2
+INFO, BEGIN, WRITE, END = 1, 2, 3, 4
+STATUS_MESSAGES = {
+  1: 'unknown command',
+  2: 'the dictionary does not fit in the EEPROM region',
+  3: 'no upload in progress',
+  4: 'the keyboard does not support this dictionary format',
+  5: 'CRC mismatch, the data was corrupted',
+}
+
+
+def crc16(data: List[int]) -> int:
+  """Computes CRC-16/CCITT-FALSE, like crc16_update() in autocorrection.c."""
+  crc = 0xffff
+  for byte in data:
+    crc ^= byte << 8
+    for _ in range(8):
+      crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xffff
+  return crc
+
+
+def make_upload(autocorrections: List[Tuple[str, str]],
+                flags: int) -> List[int]:
+  """Compiles the dictionary to the stored format, a header then the trie."""
+  entries = generator.expand_word_breaks(autocorrections)
+  data = generator.serialize_trie(entries, generator.make_trie(entries),
+                                  bool(flags & FLAG_BITMAP_NODES))
+  generator.verify_trie(entries, data)
+  lengths = [len(typo) for typo, _ in autocorrections]
+  crc = crc16(data)
+  return [FORMAT_VERSION, flags, min(lengths), max(lengths),
+          len(data) & 255, len(data) >> 8, crc & 255, crc >> 8] + data
+
+
+class HidrawDevice:
+  """A keyboard's raw HID interface through Linux hidraw."""
+
+  def __init__(self, path: str):
+    self.fd = os.open(path, os.O_RDWR)
+
+  def transfer(self, report: bytes) -> bytes:
+    os.write(self.fd, b'\0' + report)  # Prefixed with report ID 0.
+    return os.read(self.fd, REPORT_SIZE)
+
+
+class SimDevice:
+  """The host stand-in, talking over its stdin and stdout."""
+
+  def __init__(self, command: str):
+    self.process = subprocess.Popen(shlex.split(command),
+                                    stdin=subprocess.PIPE,
+                                    stdout=subprocess.PIPE)
+
+  def transfer(self, report: bytes) -> bytes:
+    self.process.stdin.write(report)
+    self.process.stdin.flush()
+    return self.process.stdout.read(REPORT_SIZE)
+
+  def close(self) -> None:
+    self.process.stdin.close()
+    self.process.wait()
+
+
+def find_device() -> str:
+  """Finds the hidraw device of the first keyboard with QMK's raw HID."""
+  for path in sorted(glob.glob('/sys/class/hidraw/hidraw*')):
+    try:
+      with open(os.path.join(path, 'device', 'report_descriptor'), 'rb') as f:
+        if RAW_HID_USAGE in f.read():
+          return os.path.join('/dev', os.path.basename(path))
+    except OSError:
+      continue
+  print('Error: No keyboard with raw HID found. Is RAW_ENABLE = yes set?')
+  sys.exit(1)
+
+
+def command(device, cmd: int, payload: List[int] = ()) -> bytes:
+  """Sends a command and returns the reply, exiting on error."""
+  report = bytes([REPORT_ID, cmd] + [0] + list(payload))
+  reply = device.transfer(report.ljust(REPORT_SIZE, b'\0'))
+  if len(reply) != REPORT_SIZE or reply[0] != REPORT_ID or reply[1] != cmd:
+    print('Error: Unexpected reply from the keyboard. Is it built with '
+          'AUTOCORRECTION_UPLOAD and autocorrection_upload_raw_hid()?')
+    sys.exit(1)
+  elif reply[2]:
+    print(f'Error: Upload failed, {STATUS_MESSAGES.get(reply[2], reply[2])}.')
+    sys.exit(1)
+  return reply
+
+
+def upload(device, autocorrections: List[Tuple[str, str]],
+           force: bool) -> None:
+  """Uploads the dictionary to `device`."""
+  info = command(device, INFO)
+  if info[3] != FORMAT_VERSION:
+    print(f'Error: The keyboard has format version {info[3]}, but this program '
+          f'makes version {FORMAT_VERSION}. Update the keyboard or program.')
+    sys.exit(1)
+  supported_flags, max_length = info[4], info[7]
+  capacity = info[5] | info[6] << 8
+
+  flags = supported_flags & FLAG_BITMAP_NODES
+  if generator.get_symbols(autocorrections) != generator.SYMBOLS:
+    if not supported_flags & FLAG_IDENTIFIERS:
+      print('Error: The dictionary has identifier symbols, but the keyboard is '
+            'not built with AUTOCORRECTION_IDENTIFIERS.')
+      sys.exit(1)
+    flags |= FLAG_IDENTIFIERS
+  blob = make_upload(autocorrections, flags)
+  if blob[3] > max_length:
+    print(f'Error: The longest typo has {blob[3]} characters, but the keyboard '
+          f'is built with AUTOCORRECTION_MAX_LENGTH {max_length}.')
+    sys.exit(1)
+  elif len(blob) > capacity:
+    print(f'Error: The dictionary is {len(blob)} bytes, but the keyboard has '
+          f'{capacity} bytes of EEPROM for it.')
+    sys.exit(1)
+  elif not force and list(info[8:8 + HEADER_SIZE]) == blob[:HEADER_SIZE]:
+    print('The keyboard already has this dictionary.')
+    return
+
+  # Write the header last, so that the keyboard never sees a valid header with
+  # data from a previous dictionary.
+  command(device, BEGIN, [len(blob) & 255, len(blob) >> 8])
+  chunk = REPORT_SIZE - 6
+  for offset in list(range(HEADER_SIZE, len(blob), chunk)) + [0]:
+    n = min(chunk, HEADER_SIZE if offset == 0 else len(blob) - offset)
+    command(device, WRITE, [offset & 255, offset >> 8, n] +
+            blob[offset:offset + n])
+  command(device, END)
+  print(f'Uploaded {len(autocorrections)} autocorrection entries with '
+        f'{len(blob)} bytes ({len(blob) - HEADER_SIZE} bytes of trie data).')
+
+
+def main(argv):
+  device_path = None
+  sim = None
+  force = False
+  args = []
+  for arg in argv[1:]:
+    if arg.startswith('--device='):
+      device_path = arg.split('=', 1)[1]
+    elif arg.startswith('--sim='):
+      sim = arg.split('=', 1)[1]
+    elif arg == '--force':
+      force = True
+    elif arg.startswith('--'):
+      print(f'Invalid option: {arg}')
+      sys.exit(1)
+    else:
+      args.append(arg)
+
+  if len(args) != 1:
+    print(__doc__)
+    sys.exit(1)
+
+  autocorrections = generator.parse_file(args[0])
+  if sim:
+    device = SimDevice(sim)
+    upload(device, autocorrections, force)
+    device.close()
+  else:
+    upload(HidrawDevice(device_path or find_device()), autocorrections, force)
+
+
+if __name__ == '__main__':
+  main(sys.argv)
@@ -0,0 +1,59 @@
+# Copyright 2024 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Tap-hold policy for the vcooley keymap, used to make achordion_data.h.
+
+This mirrors QMK's per-key tap-hold callbacks in vcooley.c. Achordion's own
+callbacks, achordion_chord(), achordion_timeout(), and
+achordion_streak_chord_timeout(), are defined only in vcooley.c. They take
+precedence over the tables, so they are not repeated here. To regenerate the
+tables, run from this directory
+
+$ qmk info -kb handwired/dactyl_manuform/vcooley/5x7 -f json > info.json
+$ python3 ../../../../../../../features/make_achordion_data.py \\
+      achordion_policy.py info.json keymap.c
+"""
+
+import re
+
+TAPPING_TERM = 190
+
+# Thumb keys can handle lower tapping terms and timeouts.
+THUMB_KEYS = ('MT(MOD_LCTL,KC_ESC)', 'LT(SYM,KC_BSPC)', 'LT(FUN,KC_SPC)')
+
+
+def is_tap_hold(key):
+  return re.match(r'(H[LR]\d|MT|LT)\(', key.keycode) is not None
+
+
+def tapping_term(key):
+  return TAPPING_TERM - 100 if key.keycode in THUMB_KEYS else TAPPING_TERM
+
+
+def quick_tap_term(key):
+  # If you quickly hold a tap-hold key after tapping it, the tap action is
+  # repeated. Key repeating is useful e.g. for Vim navigation keys, but can
+  # lead to missed triggers in fast typing. Here, returning 0 means we
+  # instead want to "force hold" and disable key repeating.
+  if key.keycode in ('HR0(KC_H)', 'HR1(KC_J)', 'HR2(KC_K)', 'HR3(KC_L)'):
+    return 120
+  elif key.keycode == 'LT(SYM,KC_BSPC)':
+    return 100
+  return 0
+
+
+def retro_tapping(key):
+  # Retro tap the space key, as I often unintentionally surpass the hold
+  # timeout on it.
+  return key.keycode == 'LT(FUN,KC_SPC)'
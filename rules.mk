@@ -30,10 +30,32 @@ NKRO_ENABLE = no
 SPACE_CADET_ENABLE ?= no
 TAP_DANCE_ENABLE ?= no
 
+USERSPACE_FEATURES_DIR := $(patsubst %/,%,$(dir \
+	$(realpath $(lastword $(MAKEFILE_LIST)))))/features
+
+# Keycode classes shared by Achordion, Sentence Case, and the other features.
+# The features below that use them set this. If you add Caps Word or
+# Autocorrection from features/ to SRC, set it to yes in your rules.mk.
+KEYCODE_CLASSES_ENABLE ?= no
+
 ACHORDION_ENABLE ?= yes
+# Achordion's tap-hold tables, made from the keymap's achordion_policy.py on
+# every build. The header is written to the keymap directory.
+ACHORDION_DATA_ENABLE ?= no
 ifeq ($(strip $(ACHORDION_ENABLE)), yes)
 	OPT_DEFS += -DACHORDION_ENABLE
 	SRC += features/achordion.c
+	# Used with ACHORDION_STREAK. Otherwise LTO drops it.
+	KEYCODE_CLASSES_ENABLE = yes
+ifeq ($(strip $(ACHORDION_DATA_ENABLE)), yes)
+	OPT_DEFS += -DACHORDION_DATA
+	ACHORDION_DATA_LOG := $(shell qmk info -kb $(KEYBOARD) -f json | \
+		python3 $(USERSPACE_FEATURES_DIR)/make_achordion_data.py \
+		$(KEYMAP_PATH)/achordion_policy.py - $(KEYMAP_PATH)/keymap.c)
+ifneq ($(.SHELLSTATUS), 0)
+$(error Failed to make achordion_data.h: $(ACHORDION_DATA_LOG))
+endif
+endif
 endif
 
 CUSTOM_SHIFT_KEYS_ENABLE ?= no
@@ -59,5 +81,10 @@ SENTENCE_CASE_ENABLE ?= yes
 ifeq ($(strip $(SENTENCE_CASE_ENABLE)), yes)
 	OPT_DEFS += -DSENTENCE_CASE_ENABLE
 	SRC += features/sentence_case.c
+	KEYCODE_CLASSES_ENABLE = yes
+endif
+
+ifeq ($(strip $(KEYCODE_CLASSES_ENABLE)), yes)
+	SRC += features/keycode_classes.c
 endif
 
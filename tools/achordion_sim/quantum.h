@@ -0,0 +1,176 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file quantum.h
+ * @brief Minimal stand-in for QMK's quantum.h to build achordion.c natively.
+ *
+ * This defines only what features/achordion.c uses, with the same names and
+ * semantics as in QMK. The timer reads the simulated clock of replay.c.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef MATRIX_ROWS
+#define MATRIX_ROWS 12
+#endif  // MATRIX_ROWS
+#ifndef MATRIX_COLS
+#define MATRIX_COLS 8
+#endif  // MATRIX_COLS
+#ifndef TAP_CODE_DELAY
+#define TAP_CODE_DELAY 0
+#endif  // TAP_CODE_DELAY
+#ifndef TAPPING_TERM
+#define TAPPING_TERM 200
+#endif  // TAPPING_TERM
+#define QUICK_TAP_TERM TAPPING_TERM
+
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+
+#define dprintf(...)
+#define dprintln(s)
+#define uprintf(...)
+#define uprintln(s)
+
+// Key events and records.
+typedef struct {
+  uint8_t col;
+  uint8_t row;
+} keypos_t;
+
+typedef enum {
+  TICK_EVENT = 0,
+  KEY_EVENT = 1,
+  COMBO_EVENT = 4,
+} keyevent_type_t;
+
+typedef struct {
+  keypos_t key;
+  uint16_t time;
+  keyevent_type_t type;
+  bool pressed;
+} keyevent_t;
+
+typedef struct {
+  bool interrupted : 1;
+  bool reserved2 : 1;
+  bool reserved1 : 1;
+  bool reserved0 : 1;
+  uint8_t count : 4;
+} tap_t;
+
+typedef struct {
+  keyevent_t event;
+  tap_t tap;
+  uint16_t keycode;
+} keyrecord_t;
+
+typedef union {
+  uint16_t code;
+} action_t;
+
+#define IS_KEYEVENT(e) ((e).type == KEY_EVENT)
+#define KEYEQ(a, b) ((a).row == (b).row && (a).col == (b).col)
+
+// Keycodes.
+enum {
+  KC_NO = 0,
+  KC_A = 0x04,
+  KC_Z = 0x1D,
+  KC_BSPC = 0x2A,
+  KC_SPACE = 0x2C,
+  KC_QUOTE = 0x34,
+  KC_COMMA = 0x36,
+  KC_DOT = 0x37,
+  KC_LCTL = 0xE0,
+  KC_LSFT,
+  KC_LALT,
+  KC_LGUI,
+  KC_RCTL,
+  KC_RSFT,
+  KC_RALT,
+  KC_RGUI,
+};
+
+#define QK_MOD_TAP 0x2000
+#define QK_MOD_TAP_MAX 0x3FFF
+#define QK_LAYER_TAP 0x4000
+#define QK_LAYER_TAP_MAX 0x4FFF
+#define QK_LAYER_MOD 0x5000
+#define QK_LAYER_MOD_MAX 0x51FF
+#define QK_TO 0x5200
+#define QK_TO_MAX 0x521F
+#define QK_MOMENTARY 0x5220
+#define QK_MOMENTARY_MAX 0x523F
+#define QK_DEF_LAYER 0x5240
+#define QK_DEF_LAYER_MAX 0x525F
+#define QK_TOGGLE_LAYER 0x5260
+#define QK_TOGGLE_LAYER_MAX 0x527F
+#define QK_ONE_SHOT_LAYER 0x5280
+#define QK_ONE_SHOT_LAYER_MAX 0x529F
+#define QK_LAYER_TAP_TOGGLE 0x52C0
+#define QK_LAYER_TAP_TOGGLE_MAX 0x52DF
+#define IS_QK_MOD_TAP(kc) ((kc) >= QK_MOD_TAP && (kc) <= QK_MOD_TAP_MAX)
+#define IS_QK_LAYER_TAP(kc) ((kc) >= QK_LAYER_TAP && (kc) <= QK_LAYER_TAP_MAX)
+#define QK_MOD_TAP_GET_TAP_KEYCODE(kc) ((kc) & 0xFF)
+#define QK_MOD_TAP_GET_MODS(kc) (((kc) >> 8) & 0x1F)
+#define QK_LAYER_TAP_GET_TAP_KEYCODE(kc) ((kc) & 0xFF)
+#define QK_LAYER_TAP_GET_LAYER(kc) (((kc) >> 8) & 0xF)
+#define MT(mod, kc) (QK_MOD_TAP | (((mod) & 0x1F) << 8) | ((kc) & 0xFF))
+
+// Mods.
+enum {
+  MOD_LCTL = 0x01,
+  MOD_LSFT = 0x02,
+  MOD_LALT = 0x04,
+  MOD_LGUI = 0x08,
+};
+#define MOD_BIT(kc) (1 << ((kc) & 7))
+#define MOD_BIT_LALT MOD_BIT(KC_LALT)
+#define MOD_MASK_SHIFT (MOD_BIT(KC_LSFT) | MOD_BIT(KC_RSFT))
+#define MOD_MASK_CTRL (MOD_BIT(KC_LCTL) | MOD_BIT(KC_RCTL))
+#define MOD_MASK_GUI (MOD_BIT(KC_LGUI) | MOD_BIT(KC_RGUI))
+#define MOD_MASK_CG (MOD_MASK_CTRL | MOD_MASK_GUI)
+#define ACTION_MODS(mods) ((mods) << 8)
+#define ACTION_MODS_TAP_KEY(mods, kc) (0x2000 | ((mods) << 8) | (kc))
+#define ACTION_LAYER_TAP_KEY(layer, kc) (0xA000 | ((layer) << 8) | (kc))
+static inline uint8_t mod_config(uint8_t mod) { return mod; }
+
+uint8_t get_mods(void);
+void send_keyboard_report(void);
+void tap_code(uint8_t keycode);
+void process_record(keyrecord_t* record);
+void process_action(keyrecord_t* record, action_t action);
+
+// Layers.
+typedef uint32_t layer_state_t;
+extern layer_state_t layer_state;
+void layer_off(uint8_t layer);
+uint8_t layer_switch_get_layer(keypos_t key);
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key);
+
+// Timer, reading the simulated clock.
+uint16_t timer_read(void);
+uint32_t timer_read32(void);
+#define timer_expired(current, future) \
+  ((uint16_t)((current) - (future)) < 0x8000)
+#define TIMER_DIFF_16(a, b) ((uint16_t)((a) - (b)))
+#define timer_elapsed(t) TIMER_DIFF_16(timer_read(), (t))
@@ -0,0 +1,435 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file replay.c
+ * @brief Replays keystroke logs through Achordion on a simulated clock.
+ *
+ * This program runs features/achordion.c natively, fed by a model of QMK's
+ * default tap-hold handling, and reports how often tap-hold keys are settled
+ * differently than intended (misfires) and how much latency is added before
+ * keys are sent. Use it like
+ *
+ *     ./replay --tapping_term=200 --timeout=250 --streak_timeout=100 a.log
+ *
+ * Each line of a log is a key event "<time ms> <row> <col> <d|u> [tap|hold]".
+ * Presses of tap-hold keys are marked with the intended outcome "tap" or
+ * "hold"; presses without a mark are regular keys. Lines starting with '#' are
+ * ignored. For example, typing "as" with home row mod-taps on A and S:
+ *
+ *     1000 1 1 d tap
+ *     1060 1 2 d tap
+ *     1090 1 1 u
+ *     1150 1 2 u
+ *
+ * Each tap-hold position is assigned a mod-tap keycode with a distinct letter
+ * as the tap keycode, and regular keys are letters. Chords are decided by the
+ * default `achordion_chord()`, the opposite hands rule, where the left hand is
+ * rows 0 to MATRIX_ROWS / 2 - 1.
+ *
+ * With --no_timeout=ROW,COL, the tap-hold key at that position has timeout 0,
+ * so that Achordion settles it as QMK decides and uses it only to settle
+ * earlier keys. The option may be repeated.
+ *
+ * The QMK model is the default tap-hold behavior: a tap-hold key is tapped if
+ * released within the tapping term, and otherwise held once the tapping term
+ * elapses. Events after a tap-hold press are buffered until it is decided.
+ * Options like PERMISSIVE_HOLD and HOLD_ON_OTHER_KEY_PRESS are not modeled.
+ *
+ * The output is a single line of "name=value" fields, parsed by sweep.py.
+ *
+ * With --check, each misfire is also printed, and the exit status is nonzero
+ * if there were any. `make check` uses this to replay the logs in testdata,
+ * whose marks are the outcomes expected of Achordion. The order of the events
+ * sent is also checked: once a tap press is sent, its release must be sent
+ * before any other key's press, also when Achordion schedules the release
+ * with TAP_CODE_DELAY. `make check` replays each log with TAP_CODE_DELAY 0
+ * and 10.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "achordion.h"
+
+#define MAX_WAITING 64
+
+enum { OUTCOME_NONE = -1, OUTCOME_TAP = 0, OUTCOME_HOLD = 1 };
+
+typedef struct {
+  uint32_t time;
+  uint8_t row;
+  uint8_t col;
+  bool pressed;
+  // Intended outcome of a tap-hold press, OUTCOME_TAP or OUTCOME_HOLD, or
+  // OUTCOME_NONE for regular keys.
+  int8_t intent;
+} event_t;
+
+typedef struct {
+  uint16_t keycode;
+  bool is_tap_hold;
+  bool no_timeout;
+  // State of the current press.
+  uint32_t press_time;
+  int8_t intent;
+  int8_t outcome;
+  bool tapped;
+} key_state_t;
+
+typedef struct {
+  uint32_t tap_hold_presses;
+  uint32_t judged;
+  uint32_t misfires;
+  uint32_t taps;
+  uint32_t holds;
+  uint32_t keys;
+  uint32_t order_errors;
+  uint64_t tap_latency;
+  uint64_t hold_latency;
+  uint64_t key_latency;
+} stats_t;
+
+// Simulated clock.
+static uint32_t sim_time = 0;
+// Configuration.
+static uint16_t tapping_term = TAPPING_TERM;
+static uint16_t timeout = 1000;
+static uint16_t streak_timeout = 200;
+static bool check = false;
+
+static key_state_t keys[MATRIX_ROWS][MATRIX_COLS];
+// The tap-hold key whose tap press was sent but not yet its release, if any.
+static bool tap_open = false;
+static keypos_t tap_open_key;
+static uint8_t num_tap_hold_keys = 0;
+static uint8_t mods = 0;
+static stats_t stats = {0};
+
+// QMK tap-hold model state.
+static bool tapping = false;
+static event_t tapping_event;
+static event_t waiting[MAX_WAITING];
+static uint8_t num_waiting = 0;
+
+uint16_t timer_read(void) { return (uint16_t)sim_time; }
+uint32_t timer_read32(void) { return sim_time; }
+uint8_t get_mods(void) { return mods; }
+void send_keyboard_report(void) {}
+void tap_code(uint8_t keycode) {}
+void process_action(keyrecord_t* record, action_t action) {}
+
+// The simulation has a single layer.
+layer_state_t layer_state = 0;
+void layer_off(uint8_t layer) {}
+uint8_t layer_switch_get_layer(keypos_t key) { return 0; }
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key) {
+  return keys[key.row][key.col].keycode;
+}
+
+uint16_t achordion_timeout(uint16_t tap_hold_keycode) {
+  for (uint8_t row = 0; row < MATRIX_ROWS; ++row) {
+    for (uint8_t col = 0; col < MATRIX_COLS; ++col) {
+      if (keys[row][col].keycode == tap_hold_keycode &&
+          keys[row][col].no_timeout) {
+        return 0;
+      }
+    }
+  }
+  return timeout;
+}
+
+// Eager mods don't change the outcome, so they're disabled to keep the
+// output simple.
+bool achordion_eager_mod(uint8_t mod) { return false; }
+
+#ifdef ACHORDION_STREAK
+uint16_t achordion_streak_chord_timeout(uint16_t tap_hold_keycode,
+                                        uint16_t next_keycode) {
+  return streak_timeout;
+}
+#endif  // ACHORDION_STREAK
+
+// Output of the pipeline, the events that would be sent to the host.
+void process_record(keyrecord_t* record) {
+  key_state_t* key = &keys[record->event.key.row][record->event.key.col];
+  if (!process_achordion(key->keycode, record)) {
+    return;
+  }
+
+  const bool hold = key->is_tap_hold && record->tap.count == 0;
+  if (tap_open && KEYEQ(tap_open_key, record->event.key)) {
+    tap_open = record->event.pressed;
+  } else if (tap_open && record->event.pressed) {
+    ++stats.order_errors;
+    if (check) {
+      printf("Order: Key %u %u was pressed at %u ms before the release of the "
+             "tap of key %u %u.\n",
+             record->event.key.row, record->event.key.col, sim_time,
+             tap_open_key.row, tap_open_key.col);
+    }
+  }
+  if (record->event.pressed && key->is_tap_hold && !hold) {
+    tap_open = true;
+    tap_open_key = record->event.key;
+  }
+
+  if (hold) {
+    const uint8_t mod = QK_MOD_TAP_GET_MODS(key->keycode);
+    if (record->event.pressed) {
+      mods |= mod;
+    } else {
+      mods &= ~mod;
+    }
+  }
+
+  if (!record->event.pressed || key->outcome != OUTCOME_NONE) {
+    return;
+  }
+
+  // First output for this press. Record the outcome and added latency.
+  const uint32_t latency = sim_time - key->press_time;
+  if (!key->is_tap_hold) {
+    key->outcome = OUTCOME_TAP;
+    ++stats.keys;
+    stats.key_latency += latency;
+    return;
+  }
+
+  key->outcome = hold ? OUTCOME_HOLD : OUTCOME_TAP;
+  if (hold) {
+    ++stats.holds;
+    stats.hold_latency += latency;
+  } else {
+    ++stats.taps;
+    stats.tap_latency += latency;
+  }
+  if (key->intent != OUTCOME_NONE) {
+    ++stats.judged;
+    if (key->intent != key->outcome) {
+      ++stats.misfires;
+      if (check) {
+        printf("Misfire: Key %u %u pressed at %u ms was %s, intended as %s.\n",
+               record->event.key.row, record->event.key.col, key->press_time,
+               hold ? "held" : "tapped", hold ? "tapped" : "held");
+      }
+    }
+  }
+}
+
+// Passes an event to Achordion as QMK would after tap-hold handling.
+static void deliver(const event_t* e, uint8_t tap_count) {
+  keyrecord_t record = {0};
+  record.event.key.row = e->row;
+  record.event.key.col = e->col;
+  record.event.time = (uint16_t)e->time | 1;
+  record.event.type = KEY_EVENT;
+  record.event.pressed = e->pressed;
+  record.tap.count = tap_count;
+  process_record(&record);
+}
+
+static void handle_event(const event_t* e);
+
+// Handles the buffered events, after the tapping key is decided.
+static void flush_waiting(void) {
+  event_t events[MAX_WAITING];
+  const uint8_t n = num_waiting;
+  memcpy(events, waiting, n * sizeof(event_t));
+  num_waiting = 0;
+  for (uint8_t i = 0; i < n; ++i) {
+    handle_event(&events[i]);
+  }
+}
+
+// Settles the tapping key as held once the tapping term elapses.
+static void tapping_task(uint32_t now) {
+  if (tapping && now - tapping_event.time >= tapping_term) {
+    tapping = false;
+    deliver(&tapping_event, 0);
+    flush_waiting();
+  }
+}
+
+// Model of QMK's default tap-hold handling for one event.
+static void handle_event(const event_t* e) {
+  key_state_t* key = &keys[e->row][e->col];
+  tapping_task(e->time);
+
+  if (tapping) {
+    if (!e->pressed && e->row == tapping_event.row &&
+        e->col == tapping_event.col) {
+      // Released within the tapping term: tapped.
+      tapping = false;
+      key->tapped = true;
+      deliver(&tapping_event, 1);
+      deliver(e, 1);
+      flush_waiting();
+    } else if (num_waiting < MAX_WAITING) {
+      waiting[num_waiting++] = *e;
+    }
+  } else if (key->is_tap_hold && e->pressed) {
+    key->tapped = false;
+    tapping = true;
+    tapping_event = *e;
+  } else {
+    deliver(e, key->tapped ? 1 : 0);
+  }
+}
+
+static uint16_t parse_option(const char* arg, const char* name) {
+  return (uint16_t)atoi(arg + strlen(name));
+}
+
+// Reads the log `file_name`, appending to `events`. Times are offset to start
+// at `start_time`. Returns the new number of events, or -1 on error.
+static int read_log(const char* file_name, uint32_t start_time,
+                    event_t** events, int num_events, int* capacity) {
+  FILE* f = fopen(file_name, "rt");
+  if (!f) {
+    fprintf(stderr, "Error: Could not open %s.\n", file_name);
+    return -1;
+  }
+
+  char line[128];
+  int line_number = 0;
+  long first_time = -1;
+  while (fgets(line, sizeof(line), f)) {
+    ++line_number;
+    long time;
+    int row, col;
+    char action[8], intent[8] = "";
+    const int n = sscanf(line, "%ld %d %d %7s %7s", &time, &row, &col, action,
+                         intent);
+    if (line[0] == '#' || n <= 0) {
+      continue;
+    } else if (n < 4 || row < 0 || row >= MATRIX_ROWS || col < 0 ||
+               col >= MATRIX_COLS || (action[0] != 'd' && action[0] != 'u')) {
+      fprintf(stderr, "Error:%s:%d: Invalid event: %s", file_name, line_number,
+              line);
+      fclose(f);
+      return -1;
+    }
+
+    if (first_time < 0) {
+      first_time = time;
+    }
+    if (num_events >= *capacity) {
+      *capacity = *capacity ? 2 * *capacity : 1024;
+      *events = realloc(*events, *capacity * sizeof(event_t));
+    }
+
+    event_t* e = &(*events)[num_events++];
+    e->time = start_time + (uint32_t)(time - first_time);
+    e->row = row;
+    e->col = col;
+    e->pressed = (action[0] == 'd');
+    e->intent = !strcmp(intent, "tap")    ? OUTCOME_TAP
+                : !strcmp(intent, "hold") ? OUTCOME_HOLD
+                                          : OUTCOME_NONE;
+
+    // Tap-hold keys are those whose presses are marked with an intent.
+    key_state_t* key = &keys[row][col];
+    if (e->pressed && e->intent != OUTCOME_NONE && !key->is_tap_hold) {
+      key->is_tap_hold = true;
+      key->keycode = MT(MOD_LCTL, KC_A + num_tap_hold_keys++ % 26);
+    }
+  }
+
+  fclose(f);
+  return num_events;
+}
+
+int main(int argc, char** argv) {
+  event_t* events = NULL;
+  int num_events = 0;
+  int capacity = 0;
+
+  for (uint8_t row = 0; row < MATRIX_ROWS; ++row) {
+    for (uint8_t col = 0; col < MATRIX_COLS; ++col) {
+      keys[row][col].keycode = KC_A + (row * MATRIX_COLS + col) % 26;
+    }
+  }
+
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    if (!strncmp(arg, "--tapping_term=", 15)) {
+      tapping_term = parse_option(arg, "--tapping_term=");
+    } else if (!strncmp(arg, "--timeout=", 10)) {
+      timeout = parse_option(arg, "--timeout=");
+    } else if (!strncmp(arg, "--streak_timeout=", 17)) {
+      streak_timeout = parse_option(arg, "--streak_timeout=");
+    } else if (!strcmp(arg, "--check")) {
+      check = true;
+    } else if (!strncmp(arg, "--no_timeout=", 13)) {
+      int row, col;
+      if (sscanf(arg + 13, "%d,%d", &row, &col) != 2 || row < 0 ||
+          row >= MATRIX_ROWS || col < 0 || col >= MATRIX_COLS) {
+        fprintf(stderr, "Invalid option: %s\n", arg);
+        return 1;
+      }
+      keys[row][col].no_timeout = true;
+    } else if (arg[0] == '-') {
+      fprintf(stderr, "Invalid option: %s\n", arg);
+      return 1;
+    } else {
+      // Logs are replayed one after another with a pause in between.
+      const uint32_t start_time =
+          num_events ? events[num_events - 1].time + 5000 : 1000;
+      num_events = read_log(arg, start_time, &events, num_events, &capacity);
+      if (num_events < 0) {
+        return 1;
+      }
+    }
+  }
+
+  if (num_events == 0) {
+    fprintf(stderr, "Use: replay [--tapping_term=N] [--timeout=N] "
+                    "[--streak_timeout=N] [--no_timeout=ROW,COL] [--check] "
+                    "log [log2 ...]\n");
+    return 1;
+  }
+
+  // Step the clock 1 ms at a time, like a matrix scan.
+  const uint32_t end_time = events[num_events - 1].time + 2000;
+  int i = 0;
+  for (sim_time = events[0].time; sim_time <= end_time; ++sim_time) {
+    tapping_task(sim_time);
+    achordion_task();
+    for (; i < num_events && events[i].time <= sim_time; ++i) {
+      if (events[i].pressed) {
+        key_state_t* key = &keys[events[i].row][events[i].col];
+        key->press_time = sim_time;
+        key->intent = events[i].intent;
+        key->outcome = OUTCOME_NONE;
+        stats.tap_hold_presses += key->is_tap_hold;
+      }
+      handle_event(&events[i]);
+    }
+  }
+
+  printf("tapping_term=%u timeout=%u streak_timeout=%u presses=%u "
+         "misfires=%u misfire_rate=%.3f tap_latency=%.1f hold_latency=%.1f "
+         "key_latency=%.1f order_errors=%u\n",
+         tapping_term, timeout, streak_timeout, stats.tap_hold_presses,
+         stats.misfires,
+         stats.judged ? (100.0 * stats.misfires) / stats.judged : 0.0,
+         stats.taps ? (double)stats.tap_latency / stats.taps : 0.0,
+         stats.holds ? (double)stats.hold_latency / stats.holds : 0.0,
+         stats.keys ? (double)stats.key_latency / stats.keys : 0.0,
+         stats.order_errors);
+
+  free(events);
+  return (check && (stats.misfires || stats.order_errors)) ? 1 : 0;
+}
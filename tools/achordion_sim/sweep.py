@@ -0,0 +1,128 @@
+# Copyright 2024 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Sweeps Achordion settings over keystroke logs, in parallel."""
+import itertools
+import multiprocessing
+import os.path
+import subprocess
+import sys
+from typing import Dict, List, Tuple
+
+HELP_TEXT = """Sweep Achordion settings over keystroke logs.
+Use: python3 sweep.py [options] log [log2 ...]
+
+Builds the native replay program with features/achordion.c, then replays the
+logs for every combination of settings, running on all CPU cores. Results are
+ranked by misfire rate, then by the added latency of taps. See replay.c for the
+log format.
+
+Options:
+  --tapping_term     Comma-separated TAPPING_TERM values (default 200).
+  --timeout          Comma-separated achordion_timeout() values
+                     (default 150,200,250,300,500,1000).
+  --streak_timeout   Comma-separated achordion_streak_chord_timeout() values
+                     (default 0,100,150,200,250).
+  --jobs             Number of parallel jobs (default: number of CPU cores).
+  --top              Show only the N best settings (default 20).
+"""
+
+SIM_DIR = os.path.dirname(os.path.abspath(__file__))
+REPLAY = os.path.join(SIM_DIR, 'replay')
+PARAMS = ('tapping_term', 'timeout', 'streak_timeout')
+
+
+def build_replay() -> None:
+  """Builds the replay program with make."""
+  result = subprocess.run(['make', '-s', '-C', SIM_DIR, 'replay'])
+  if result.returncode != 0:
+    print('Error: Failed to build the replay program.')
+    sys.exit(1)
+
+
+def run_replay(args: Tuple[Tuple[int, ...], List[str]]) -> Dict[str, float]:
+  """Replays the logs with one combination of settings."""
+  values, log_files = args
+  options = [f'--{name}={value}' for name, value in zip(PARAMS, values)]
+  output = subprocess.run([REPLAY] + options + log_files, check=True,
+                          capture_output=True, text=True).stdout
+  return {name: float(value) for name, value in
+          (field.split('=', 1) for field in output.split())}
+
+
+def parse_values(value: str) -> List[int]:
+  """Parses a comma-separated list of ints."""
+  try:
+    return [int(v) for v in value.split(',')]
+  except ValueError:
+    print(f'Invalid values: {value}')
+    sys.exit(1)
+
+
+def print_results_table(results: List[Dict[str, float]], top: int) -> None:
+  """Prints results ranked by misfire rate, then tap latency."""
+  results = sorted(results,
+                   key=lambda r: (r['misfire_rate'], r['tap_latency']))
+  print('Rank   term timeout streak  misfires        %   tap ms  hold ms   '
+        'key ms')
+  for i, r in enumerate(results[:top]):
+    print(f'#{(i + 1):<4} {r["tapping_term"]:5.0f} {r["timeout"]:7.0f} '
+          f'{r["streak_timeout"]:6.0f} {r["misfires"]:9.0f} '
+          f'{r["misfire_rate"]:8.3f} {r["tap_latency"]:8.1f} '
+          f'{r["hold_latency"]:8.1f} {r["key_latency"]:8.1f}')
+
+  print(f'\n{len(results)} settings, {results[0]["presses"]:.0f} tap-hold '
+        'presses each.\n')
+
+
+def main(argv):
+  values = {
+    'tapping_term': [200],
+    'timeout': [150, 200, 250, 300, 500, 1000],
+    'streak_timeout': [0, 100, 150, 200, 250],
+  }
+  jobs = multiprocessing.cpu_count()
+  top = 20
+  log_files = []
+
+  for arg in argv[1:]:
+    if arg.startswith('--'):  # Parse command line options.
+      option, value = arg.split('=', 1)
+      if option[2:] in values:
+        values[option[2:]] = parse_values(value)
+      elif option == '--jobs':
+        jobs = int(value)
+      elif option == '--top':
+        top = int(value)
+      else:
+        print(f'Invalid option: {arg}')
+        sys.exit(1)
+
+    else:
+      log_files.append(os.path.abspath(arg))
+
+  if not log_files:  # No input given; show help text and exit.
+    print(HELP_TEXT)
+    sys.exit(1)
+
+  build_replay()
+  settings = list(itertools.product(*(values[name] for name in PARAMS)))
+  with multiprocessing.Pool(jobs) as pool:
+    results = pool.map(run_replay, [(s, log_files) for s in settings])
+
+  print_results_table(results, top)
+
+
+if __name__ == '__main__':
+  main(sys.argv)
@@ -0,0 +1,261 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file bench.c
+ * @brief Benchmarks autocorrection by typing text corpora.
+ *
+ * This program runs features/autocorrection.c natively with a generated
+ * autocorrection_data.h, types text files on the keyboard, and reports the
+ * time and PROGMEM reads per key and the corrections made. The text is assumed
+ * to be correctly spelled, so that every correction is a false trigger. It is
+ * built and run for each dictionary format by bench.py, or by hand like
+ *
+ *     make build/trie/bench  # With build/trie/autocorrection_data.h.
+ *     ./build/trie/bench --repeat=5 corpus1.txt corpus2.txt
+ *
+ * Characters are typed as in device.c, uppercase with shift held. Slips are
+ * mixed in to exercise the other paths: with probability --backspace_rate,
+ * a random letter is typed and deleted with backspace before a letter, and
+ * with --mod_rate, a Ctrl+letter shortcut is tapped before a space. With a
+ * layered dictionary, --layers sets the mask of the enabled layers.
+ *
+ * The keys are typed once to count reads and corrections, then --repeat more
+ * times to time them, and the fastest time is reported. The time includes
+ * counting the reads, about one instruction per read.
+ *
+ * The output is a line "trigger <word>" for each correction, naming the corpus
+ * word being typed, and a line "worst <word>" for the key with the most reads,
+ * then a single line of "name=value" fields, parsed by bench.py. The field
+ * text_hash is a hash of the autocorrected text, to check that dictionary
+ * formats make the same corrections.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "autocorrection.h"
+#include "keyboard.h"
+
+typedef struct {
+  uint16_t keycode;
+  uint8_t mods;
+  char c;
+  // Offset in the corpus of the character being typed.
+  uint32_t offset;
+} keystroke_t;
+
+static char* corpus = NULL;
+static size_t corpus_size = 0;
+static keystroke_t* keys = NULL;
+static size_t num_keys = 0;
+static size_t keys_capacity = 0;
+static uint32_t rng_state = 1;
+
+// Appends the file `file_name` to the corpus, returning false on error.
+static bool read_corpus(const char* file_name) {
+  FILE* f = fopen(file_name, "rb");
+  if (!f) {
+    fprintf(stderr, "Error opening %s\n", file_name);
+    return false;
+  }
+  char buffer[65536];
+  for (size_t n; (n = fread(buffer, 1, sizeof(buffer), f)) > 0;) {
+    corpus = realloc(corpus, corpus_size + n + 1);
+    if (!corpus) {
+      fprintf(stderr, "Out of memory.\n");
+      exit(1);
+    }
+    memcpy(corpus + corpus_size, buffer, n);
+    corpus_size += n;
+  }
+  const bool ok = !ferror(f);
+  fclose(f);
+  // Separate files with a newline, so that words don't run together.
+  corpus[corpus_size++] = '\n';
+  return ok;
+}
+
+// Xorshift random number in [0, 1).
+static double random_uniform(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state / 4294967296.0;
+}
+
+static void add_key(uint16_t keycode, uint8_t mods, char c, uint32_t offset) {
+  if (num_keys == keys_capacity) {
+    keys_capacity = keys_capacity ? 2 * keys_capacity : 65536;
+    keys = realloc(keys, keys_capacity * sizeof(keystroke_t));
+    if (!keys) {
+      fprintf(stderr, "Out of memory.\n");
+      exit(1);
+    }
+  }
+  keys[num_keys++] = (keystroke_t){keycode, mods, c, offset};
+}
+
+// Makes the keys to type the corpus, with slips mixed in.
+static void make_keys(double backspace_rate, double mod_rate) {
+  for (size_t i = 0; i < corpus_size; ++i) {
+    const char c = corpus[i];
+    bool shift_held;
+    const uint16_t keycode = char_to_keycode(c, &shift_held);
+    if (KC_A <= keycode && keycode <= KC_Z &&
+        random_uniform() < backspace_rate) {
+      const int letter = (int)(random_uniform() * 26);
+      add_key(KC_A + letter, 0, 'a' + letter, i);
+      add_key(KC_BSPC, 0, '\b', i);
+    } else if (c == ' ' && random_uniform() < mod_rate) {
+      add_key(KC_A + (int)(random_uniform() * 26), MOD_BIT(KC_LCTL), 0, i);
+    }
+    add_key(keycode, shift_held ? MOD_BIT(KC_LSFT) : 0, c, i);
+  }
+}
+
+static bool is_word_char(char c) {
+  return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') ||
+         ('0' <= c && c <= '9') || c == '\'' || c == '_' || c == '-';
+}
+
+// Prints "`label` <word>" for the word around `offset` in the corpus. At a
+// word break, this is the word before.
+static void print_word(const char* label, uint32_t offset) {
+  size_t start = offset;
+  if (!is_word_char(corpus[offset]) && offset > 0) {
+    --start;
+  }
+  size_t end = start;
+  while (start > 0 && is_word_char(corpus[start - 1])) {
+    --start;
+  }
+  while (end < corpus_size && is_word_char(corpus[end])) {
+    ++end;
+  }
+  printf("%s %.*s\n", label, (int)(end - start), corpus + start);
+}
+
+static double now_ns(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+// Types all keys, returning the elapsed time in ns.
+static double type_keys(void) {
+  text_size = 0;
+  const double start = now_ns();
+  for (size_t i = 0; i < num_keys; ++i) {
+    mods = keys[i].mods;
+    tap_key(keys[i].keycode, keys[i].c);
+  }
+  return now_ns() - start;
+}
+
+static double parse_rate(const char* arg, const char* option) {
+  return atof(arg + strlen(option));
+}
+
+int main(int argc, char** argv) {
+  double backspace_rate = 0.02;
+  double mod_rate = 0.005;
+  int repeat = 5;
+  int num_files = 0;
+
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    if (!strncmp(arg, "--backspace_rate=", 17)) {
+      backspace_rate = parse_rate(arg, "--backspace_rate=");
+    } else if (!strncmp(arg, "--mod_rate=", 11)) {
+      mod_rate = parse_rate(arg, "--mod_rate=");
+    } else if (!strncmp(arg, "--repeat=", 9)) {
+      repeat = atoi(arg + 9);
+    } else if (!strncmp(arg, "--layers=", 9)) {
+      autocorrection_set_layers((uint8_t)atoi(arg + 9));
+    } else if (!strncmp(arg, "--seed=", 7)) {
+      rng_state = (uint32_t)atoi(arg + 7) * 2654435761u | 1;
+    } else if (arg[0] == '-') {
+      fprintf(stderr, "Invalid option: %s\n", arg);
+      return 1;
+    } else if (!read_corpus(arg)) {
+      return 1;
+    } else {
+      ++num_files;
+    }
+  }
+
+  if (num_files == 0) {
+    fprintf(stderr, "Use: bench [--backspace_rate=P] [--mod_rate=P] "
+                    "[--repeat=N] [--seed=N] [--layers=MASK] "
+                    "file [file2 ...]\n");
+    return 1;
+  }
+
+  make_keys(backspace_rate, mod_rate);
+  uint32_t words = 0;
+  for (size_t i = 0; i < corpus_size; ++i) {
+    words += is_word_char(corpus[i]) &&
+             (i == 0 || !is_word_char(corpus[i - 1]));
+  }
+
+  // Count reads and corrections, key by key.
+  uint32_t max_reads = 0;
+  uint32_t max_reads_offset = 0;
+  // Keys settled with at most one read, e.g. by the quick reject.
+  uint32_t cheap_keys = 0;
+  for (size_t i = 0; i < num_keys; ++i) {
+    const uint64_t reads = pgm_reads;
+    const uint32_t corrections = num_corrections;
+    mods = keys[i].mods;
+    tap_key(keys[i].keycode, keys[i].c);
+    cheap_keys += (pgm_reads - reads <= 1);
+    if (pgm_reads - reads > max_reads) {
+      max_reads = pgm_reads - reads;
+      max_reads_offset = keys[i].offset;
+    }
+    if (num_corrections != corrections) {
+      print_word("trigger", keys[i].offset);
+    }
+  }
+  print_word("worst", max_reads_offset);
+  const uint64_t total_reads = pgm_reads;
+  const uint32_t total_corrections = num_corrections;
+  uint32_t text_hash = 2166136261u;  // FNV-1a.
+  for (size_t i = 0; i < text_size; ++i) {
+    text_hash = (text_hash ^ (uint8_t)text[i]) * 16777619u;
+  }
+
+  double best_ns = 0.0;
+  for (int i = 0; i < repeat; ++i) {
+    const double ns = type_keys();
+    if (i == 0 || ns < best_ns) {
+      best_ns = ns;
+    }
+  }
+
+  printf("keys=%zu words=%u corrections=%u per_kwords=%.3f ns_per_key=%.2f "
+         "mean_reads=%.3f max_reads=%u cheap_keys=%.2f text_hash=%u\n",
+         num_keys, words, total_corrections,
+         words ? (1000.0 * total_corrections) / words : 0.0,
+         num_keys && repeat ? best_ns / num_keys : 0.0,
+         num_keys ? (double)total_reads / num_keys : 0.0, max_reads,
+         num_keys ? (100.0 * cheap_keys) / num_keys : 0.0, text_hash);
+
+  free(keys);
+  free(corpus);
+  free(text);
+  return 0;
+}
@@ -0,0 +1,224 @@
+# Copyright 2024 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Benchmarks autocorrection dictionary formats on text corpora."""
+import collections
+import contextlib
+import io
+import os
+import os.path
+import subprocess
+import sys
+from typing import Dict, List, Optional, Tuple
+
+SIM_DIR = os.path.dirname(os.path.abspath(__file__))
+FEATURES_DIR = os.path.join(SIM_DIR, '..', '..', 'features')
+sys.path.insert(0, FEATURES_DIR)
+with contextlib.redirect_stdout(io.StringIO()):
+  import make_autocorrection_data as generator
+
+HELP_TEXT = """Benchmark autocorrection dictionary formats on text corpora.
+Use: python3 bench.py [options] corpus [corpus2 ...]
+
+Generates autocorrection_data.h for each format of the dictionary, builds the
+native bench program with features/autocorrection.c for each, and types the
+corpus on it. A corpus is a text file or a directory, whose files are all used.
+Reported per format are the flash size, time per key, mean and worst PROGMEM
+reads per key, the keys settled with at most one read (as with the quick
+reject), and the corrections made. The corpus is assumed to be correctly
+spelled, so corrections are false triggers; the words that trigger them are
+listed. See bench.c for how the text is typed.
+
+Options:
+  --dict            Dictionary file (default features/autocorrection_dict.txt),
+                    or a comma-separated list of dictionaries to merge as
+                    layers (not with the automaton).
+  --layers          Mask of the enabled layers, e.g. 2 for only the second
+                    dictionary (default all).
+  --formats         Comma-separated formats among trie, bitmap_nodes,
+                    automaton, packed_strings (the trie with packed strings),
+                    and quick_reject (the trie with the quick reject bitset)
+                    (default all).
+  --repeat          Times to type the corpus for timing, taking the fastest
+                    (default 5).
+  --backspace_rate  Probability of a slip fixed with backspace before a letter
+                    (default 0.02).
+  --mod_rate        Probability of a Ctrl shortcut before a space
+                    (default 0.005).
+  --seed            Random seed for the slips (default 0).
+  --top             Show only the N most frequent false triggers (default 20).
+"""
+
+FORMATS = ('trie', 'bitmap_nodes', 'automaton', 'packed_strings',
+           'quick_reject')
+
+
+def list_corpus_files(paths: List[str]) -> List[str]:
+  """Lists the files of the corpus, expanding directories."""
+  files = []
+  for path in paths:
+    if os.path.isdir(path):
+      for root, dirs, names in os.walk(path):
+        dirs.sort()
+        files.extend(os.path.join(root, name) for name in sorted(names)
+                     if not name.startswith('.'))
+    else:
+      files.append(path)
+  return [os.path.abspath(f) for f in files]
+
+
+def generate_data(autocorrections: List[Tuple[str, str]], format_name: str,
+                  layer_files: Optional[List[str]] = None,
+                  layer_masks: Optional[Dict[str, int]] = None) -> int:
+  """Writes build/<format>/autocorrection_data.h, returning its size."""
+  entries = generator.expand_word_breaks(autocorrections, layer_masks)
+  automaton = format_name == 'automaton'
+  bitmap_nodes = format_name == 'bitmap_nodes'
+  packed_strings = format_name == 'packed_strings'
+  quick_reject = None
+  if format_name == 'quick_reject':
+    quick_reject = generator.make_quick_reject(entries)
+  if automaton:
+    data = generator.make_automaton(entries)
+  else:
+    data = generator.serialize_trie(entries, generator.make_trie(entries),
+                                    bitmap_nodes, packed_strings=packed_strings,
+                                    layer_masks=layer_masks)
+    generator.verify_trie(entries, data, packed_strings, layer_masks)
+
+  build_dir = os.path.join(SIM_DIR, 'build', format_name)
+  os.makedirs(build_dir, exist_ok=True)
+  h_file = os.path.join(build_dir, 'autocorrection_data.h')
+  # Rewrite the header only if it changed, so that make skips the rebuild.
+  temp_file = h_file + '.new'
+  generator.write_generated_code(autocorrections, data, temp_file, automaton,
+                                 bitmap_nodes, packed_strings, quick_reject,
+                                 layer_files, layer_masks)
+  if (os.path.exists(h_file) and
+      open(h_file, 'rb').read() == open(temp_file, 'rb').read()):
+    os.remove(temp_file)
+  else:
+    os.replace(temp_file, h_file)
+  return len(data) + len(quick_reject or [])
+
+
+def run_bench(format_name: str, options: List[str],
+              corpus_files: List[str]) -> Tuple[Dict[str, float], List[str],
+                                                str]:
+  """Builds and runs the benchmark for a format.
+
+  Returns:
+    (results, triggers, worst), where results are the "name=value" fields,
+    triggers the words that triggered corrections, and worst the word with
+    the most PROGMEM reads on a key.
+  """
+  target = os.path.join('build', format_name, 'bench')
+  result = subprocess.run(['make', '-s', '-C', SIM_DIR, target],
+                          stderr=subprocess.DEVNULL)
+  if result.returncode != 0:
+    print(f'Error: Failed to build the bench program for {format_name}.')
+    sys.exit(1)
+
+  output = subprocess.run([os.path.join(SIM_DIR, target)] + options +
+                          corpus_files, check=True, capture_output=True,
+                          text=True, errors='replace').stdout
+  triggers = []
+  worst = ''
+  for line in output.splitlines():
+    if line.startswith('trigger '):
+      triggers.append(line[8:])
+    elif line.startswith('worst '):
+      worst = line[6:]
+    else:
+      results = {name: float(value) for name, value in
+                 (field.split('=', 1) for field in line.split())}
+  return results, triggers, worst
+
+
+def main(argv):
+  dict_files = [os.path.join(FEATURES_DIR, 'autocorrection_dict.txt')]
+  formats = list(FORMATS)
+  options = []
+  top = 20
+  paths = []
+
+  for arg in argv[1:]:
+    if arg.startswith('--'):  # Parse command line options.
+      option, value = arg.split('=', 1)
+      if option == '--dict':
+        dict_files = value.split(',')
+      elif option == '--formats':
+        formats = value.split(',')
+        if not set(formats) <= set(FORMATS):
+          print(f'Invalid formats: {value}')
+          sys.exit(1)
+      elif option in ('--repeat', '--backspace_rate', '--mod_rate',
+                      '--seed', '--layers'):
+        options.append(arg)
+      elif option == '--top':
+        top = int(value)
+      else:
+        print(f'Invalid option: {arg}')
+        sys.exit(1)
+    else:
+      paths.append(arg)
+
+  if not paths:  # No input given; show help text and exit.
+    print(HELP_TEXT)
+    sys.exit(1)
+
+  corpus_files = list_corpus_files(paths)
+  layer_files = layer_masks = None
+  if len(dict_files) > 1:
+    if 'automaton' in formats:
+      print('Skipping the automaton, which does not support layers.')
+      formats.remove('automaton')
+    layer_files = dict_files
+    with contextlib.redirect_stdout(io.StringIO()):
+      layers = [generator.parse_file(f) for f in dict_files]
+    autocorrections, layer_masks = generator.merge_layers(dict_files, layers)
+  else:
+    with contextlib.redirect_stdout(io.StringIO()):
+      autocorrections = generator.parse_file(dict_files[0])
+
+  print('Format           bytes  ns/key  mean reads  worst reads  <=1 read  '
+        'corrections  per 1k words')
+  text_hash = None
+  for format_name in formats:
+    size = generate_data(autocorrections, format_name, layer_files,
+                         layer_masks)
+    results, triggers, worst = run_bench(format_name, options, corpus_files)
+    print(f'{format_name:<14} {size:6d} {results["ns_per_key"]:7.1f} '
+          f'{results["mean_reads"]:11.2f} {results["max_reads"]:12.0f} '
+          f'{results["cheap_keys"]:8.1f}%  '
+          f'{results["corrections"]:11.0f} {results["per_kwords"]:13.3f}')
+    if text_hash is None:
+      text_hash = results['text_hash']
+      trigger_counts = collections.Counter(triggers)
+      worst_word = worst
+    elif results['text_hash'] != text_hash:
+      print(f'Warning: {format_name} made different corrections than '
+            f'{formats[0]}.')
+
+  print(f'\n{len(corpus_files)} files, {results["keys"]:.0f} keys, '
+        f'{results["words"]:.0f} words. The most reads on a key were in '
+        f'"{worst_word}" ({formats[0]}).')
+  if trigger_counts:
+    print('\nFalse triggers, by the corpus word being typed:')
+    for word, count in trigger_counts.most_common(top):
+      print(f'  {count:6d}  {word}')
+
+
+if __name__ == '__main__':
+  main(sys.argv)
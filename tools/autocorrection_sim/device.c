@@ -0,0 +1,144 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file device.c
+ * @brief Host stand-in of a keyboard with an uploadable autocorrection
+ * dictionary.
+ *
+ * This program runs features/autocorrection.c natively, built with
+ * AUTOCORRECTION_UPLOAD, with EEPROM kept in a file. It has two modes:
+ *
+ * By default, it serves the raw HID upload protocol on stdin and stdout, one
+ * 32-byte report at a time. upload_autocorrection_dict.py talks to it with
+ * the --sim option:
+ *
+ *     python3 ../../features/upload_autocorrection_dict.py \
+ *         --sim="./device --eeprom=eeprom.bin" dict.txt
+ *
+ * With --type, it types the text read from stdin on the keyboard and prints
+ * the text as autocorrected, using the dictionary stored in EEPROM:
+ *
+ *     echo "the lenght of thier ouput" | ./device --eeprom=eeprom.bin --type
+ *
+ * In the text, '\b' is typed as backspace, uppercase letters with shift held,
+ * and shifted symbols like '_' as shifted keycodes like KC_UNDS, as on a US
+ * layout.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "autocorrection.h"
+#include "keyboard.h"
+
+#define RAW_EPSIZE 32
+
+static uint8_t eeprom[AUTOCORRECTION_EEPROM_SIZE];
+static bool eeprom_dirty = false;
+
+static size_t eeprom_index(const void* addr, size_t len) {
+  const size_t i = (size_t)addr;
+  if (i + len > sizeof(eeprom)) {
+    fprintf(stderr, "EEPROM access out of range: %zu\n", i + len);
+    exit(1);
+  }
+  return i;
+}
+
+uint8_t eeprom_read_byte(const uint8_t* addr) {
+  return eeprom[eeprom_index(addr, 1)];
+}
+
+void eeprom_update_byte(uint8_t* addr, uint8_t value) {
+  eeprom_update_block(&value, addr, 1);
+}
+
+void eeprom_read_block(void* buf, const void* addr, size_t len) {
+  memcpy(buf, eeprom + eeprom_index(addr, len), len);
+}
+
+void eeprom_update_block(const void* buf, void* addr, size_t len) {
+  memcpy(eeprom + eeprom_index(addr, len), buf, len);
+  eeprom_dirty = true;
+}
+
+// Types `in` on the keyboard, printing the autocorrected text.
+static void type_text(FILE* in) {
+  for (int c; (c = fgetc(in)) != EOF;) {
+    bool shift_held;
+    const uint16_t keycode = char_to_keycode(c, &shift_held);
+    mods = shift_held ? MOD_BIT(KC_LSFT) : 0;
+    tap_key(keycode, c);
+  }
+  fwrite(text, 1, text_size, stdout);
+}
+
+// Serves the raw HID upload protocol over stdin and stdout.
+static void serve_raw_hid(void) {
+  uint8_t report[RAW_EPSIZE];
+  while (fread(report, 1, sizeof(report), stdin) == sizeof(report)) {
+    if (report[0] == 'C') {
+      autocorrection_upload_raw_hid(report, sizeof(report));
+    } else {
+      report[0] = 0xFF;  // Unhandled, like VIA's id_unhandled.
+    }
+    fwrite(report, 1, sizeof(report), stdout);
+    fflush(stdout);
+  }
+}
+
+int main(int argc, char** argv) {
+  const char* eeprom_file = "eeprom.bin";
+  bool type = false;
+
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    if (!strncmp(arg, "--eeprom=", 9)) {
+      eeprom_file = arg + 9;
+    } else if (!strcmp(arg, "--type")) {
+      type = true;
+    } else {
+      fprintf(stderr, "Use: device [--eeprom=FILE] [--type]\n");
+      return 1;
+    }
+  }
+
+  // Load EEPROM, or start erased if there is no file yet.
+  memset(eeprom, 0xFF, sizeof(eeprom));
+  FILE* f = fopen(eeprom_file, "rb");
+  if (f) {
+    if (fread(eeprom, 1, sizeof(eeprom), f) == 0 && ferror(f)) {
+      fprintf(stderr, "Error reading %s\n", eeprom_file);
+      return 1;
+    }
+    fclose(f);
+  }
+
+  if (type) {
+    type_text(stdin);
+  } else {
+    serve_raw_hid();
+  }
+
+  if (eeprom_dirty) {
+    f = fopen(eeprom_file, "wb");
+    if (!f || fwrite(eeprom, 1, sizeof(eeprom), f) != sizeof(eeprom)) {
+      fprintf(stderr, "Error writing %s\n", eeprom_file);
+      return 1;
+    }
+    fclose(f);
+  }
+  return 0;
+}
@@ -0,0 +1,109 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file keyboard.c
+ * @brief Model of typing on a keyboard running autocorrection.
+ */
+
+#include "keyboard.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "autocorrection.h"
+
+char* text = NULL;
+size_t text_size = 0;
+static size_t text_capacity = 0;
+uint8_t mods = 0;
+uint32_t num_corrections = 0;
+uint64_t pgm_reads = 0;
+// Whether autocorrection sent keys while handling the current key.
+static bool sent = false;
+
+static void append(char c) {
+  if (text_size == text_capacity) {
+    text_capacity = text_capacity ? 2 * text_capacity : 4096;
+    text = realloc(text, text_capacity);
+    if (!text) {
+      fprintf(stderr, "Out of memory.\n");
+      exit(1);
+    }
+  }
+  text[text_size++] = c;
+}
+
+uint8_t get_mods(void) { return mods; }
+uint8_t get_oneshot_mods(void) { return 0; }
+
+void tap_code(uint8_t keycode) {
+  sent = true;
+  if (keycode == KC_BSPC && text_size > 0) {
+    --text_size;
+  }
+}
+
+void send_char(char c) {
+  sent = true;
+  append(c);
+}
+
+void send_string_P(const char* str) {
+  sent = true;
+  while (*str) {
+    append(*str++);
+  }
+}
+
+// Characters typed by keycodes KC_1 to KC_SLSH, unshifted and shifted, on a US
+// layout. KC_NUHS is left out, so that '#' and '~' are found as S(KC_3) and
+// S(KC_GRV).
+static const char unshifted_chars[] = "1234567890\n\x1b\b\t -=[]\\\0;'`,./";
+static const char shifted_chars[] = "!@#$%^&*()\n\x1b\b\t _+{}|\0:\"~<>?";
+
+uint16_t char_to_keycode(char c, bool* shift_held) {
+  *shift_held = false;
+  if ('a' <= c && c <= 'z') {
+    return KC_A + (c - 'a');
+  } else if ('A' <= c && c <= 'Z') {
+    *shift_held = true;
+    return KC_A + (c - 'A');
+  }
+  for (int i = 0; i <= KC_SLSH - KC_1; ++i) {
+    if (c && unshifted_chars[i] == c) {
+      return KC_1 + i;
+    } else if (c && shifted_chars[i] == c) {
+      return S(KC_1 + i);
+    }
+  }
+  return KC_F1;
+}
+
+void tap_key(uint16_t keycode, char c) {
+  keyrecord_t record = {0};
+  record.event.pressed = true;
+  sent = false;
+  const bool pass = process_autocorrection(keycode, &record);
+  num_corrections += sent;
+  if (pass) {
+    if (keycode == KC_BSPC) {
+      tap_code(KC_BSPC);
+    } else if (c) {
+      append(c);
+    }
+  }
+  record.event.pressed = false;
+  process_autocorrection(keycode, &record);
+}
@@ -0,0 +1,49 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file keyboard.h
+ * @brief Model of typing on a keyboard running autocorrection.
+ *
+ * Keys are pressed through process_autocorrection(), and the text that the
+ * host would see, including corrections, is kept in a buffer.
+ */
+
+#pragma once
+
+#include "quantum.h"
+
+// The text typed so far.
+extern char* text;
+extern size_t text_size;
+// Mods held while typing.
+extern uint8_t mods;
+// Number of corrections made, counted as the key presses on which
+// autocorrection sent keys.
+extern uint32_t num_corrections;
+
+/**
+ * Finds the keycode that types `c` on a US layout, and whether shift is held
+ * for it. Uppercase letters are typed with shift held, and shifted symbols
+ * like '_' as shifted keycodes like KC_UNDS. '\b' is backspace. Other
+ * characters get a keycode that autocorrection treats as clearing its state.
+ */
+uint16_t char_to_keycode(char c, bool* shift_held);
+
+/**
+ * Presses and releases `keycode`. Unless blocked by autocorrection, the key
+ * types `c` into the text, or deletes the last character if backspace. If `c`
+ * is 0, the key types nothing, like a shortcut.
+ */
+void tap_key(uint16_t keycode, char c);
@@ -0,0 +1,134 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file quantum.h
+ * @brief Minimal stand-in for QMK's quantum.h to build autocorrection.c
+ * natively.
+ *
+ * This defines only what features/autocorrection.c uses, with the same names
+ * and values as in QMK. Keys are "sent" to a text buffer in keyboard.c, and
+ * EEPROM is an array in device.c.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+// PROGMEM reads are counted in `pgm_reads`, for bench.c. The keycode class
+// table is read once per key whatever the dictionary, so keycode_classes.c is
+// built with SIM_UNCOUNTED_READS to count only the dictionary reads.
+#ifdef SIM_UNCOUNTED_READS
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#else
+extern uint64_t pgm_reads;
+#define pgm_read_byte(p) (++pgm_reads, *(const uint8_t*)(p))
+#endif  // SIM_UNCOUNTED_READS
+
+#define dprintf(...)
+#define dprintln(s)
+
+// Key events and records.
+typedef struct {
+  uint8_t col;
+  uint8_t row;
+} keypos_t;
+
+typedef struct {
+  keypos_t key;
+  uint16_t time;
+  bool pressed;
+} keyevent_t;
+
+typedef struct {
+  bool interrupted : 1;
+  bool reserved2 : 1;
+  bool reserved1 : 1;
+  bool reserved0 : 1;
+  uint8_t count : 4;
+} tap_t;
+
+typedef struct {
+  keyevent_t event;
+  tap_t tap;
+} keyrecord_t;
+
+// Keycodes.
+enum {
+  KC_NO = 0,
+  KC_A = 0x04,
+  KC_Z = 0x1D,
+  KC_1 = 0x1E,
+  KC_0 = 0x27,
+  KC_ENT = 0x28,
+  KC_ESC = 0x29,
+  KC_BSPC = 0x2A,
+  KC_TAB = 0x2B,
+  KC_SPC = 0x2C,
+  KC_MINS = 0x2D,
+  KC_QUOT = 0x34,
+  KC_DOT = 0x37,
+  KC_SLSH = 0x38,
+  KC_CAPS = 0x39,
+  KC_F1 = 0x3A,
+  KC_LCTL = 0xE0,
+  KC_LSFT = 0xE1,
+  KC_RSFT = 0xE5,
+  KC_RGUI = 0xE7,
+};
+
+#define QK_LSFT 0x0200
+#define QK_RSFT 0x1200
+#define QK_MODS_GET_BASIC_KEYCODE(kc) ((kc) & 0xFF)
+#define S(kc) ((kc) | QK_LSFT)
+#define QK_MOD_TAP 0x2000
+#define QK_MOD_TAP_MAX 0x3FFF
+#define QK_LAYER_TAP 0x4000
+#define QK_LAYER_TAP_MAX 0x4FFF
+#define QK_LAYER_MOD 0x5000
+#define QK_LAYER_MOD_MAX 0x51FF
+#define QK_TO 0x5200
+#define QK_TO_MAX 0x521F
+#define QK_MOMENTARY 0x5220
+#define QK_MOMENTARY_MAX 0x523F
+#define QK_DEF_LAYER 0x5240
+#define QK_DEF_LAYER_MAX 0x525F
+#define QK_TOGGLE_LAYER 0x5260
+#define QK_TOGGLE_LAYER_MAX 0x527F
+#define QK_ONE_SHOT_LAYER 0x5280
+#define QK_ONE_SHOT_LAYER_MAX 0x529F
+#define QK_ONE_SHOT_MOD 0x52A0
+#define QK_ONE_SHOT_MOD_MAX 0x52BF
+#define QK_LAYER_TAP_TOGGLE 0x52C0
+#define QK_LAYER_TAP_TOGGLE_MAX 0x52DF
+
+// Mods.
+#define MOD_BIT(kc) (1 << ((kc) & 7))
+#define MOD_MASK_SHIFT (MOD_BIT(KC_LSFT) | MOD_BIT(KC_RSFT))
+
+uint8_t get_mods(void);
+uint8_t get_oneshot_mods(void);
+void tap_code(uint8_t keycode);
+void send_char(char c);
+void send_string_P(const char* str);
+
+// EEPROM, addressed from 0.
+uint8_t eeprom_read_byte(const uint8_t* addr);
+void eeprom_update_byte(uint8_t* addr, uint8_t value);
+void eeprom_read_block(void* buf, const void* addr, size_t len);
+void eeprom_update_block(const void* buf, void* addr, size_t len);
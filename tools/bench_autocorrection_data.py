@@ -0,0 +1,165 @@
+# Copyright 2024 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Times make_autocorrection_data.py on large generated dictionaries."""
+import contextlib
+import io
+import os.path
+import random
+import sys
+import tempfile
+import time
+from typing import List, Set, Tuple
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                '..', 'features'))
+with contextlib.redirect_stdout(io.StringIO()):
+  import make_autocorrection_data as generator
+
+HELP_TEXT = """Time make_autocorrection_data.py on large generated dictionaries.
+Use: python3 bench_autocorrection_data.py [options]
+
+Makes dictionaries of typos by randomly misspelling words, then times each step
+of make_autocorrection_data.py on them: validating the typos and checking them
+against the word list, building the trie, and serializing it. Serializing is
+skipped when the table would exceed the 64KB limit of the links.
+
+Options:
+  --sizes   Comma-separated dictionary sizes (default 1000,3000,10000,30000,
+            100000).
+  --words   Word list file, one word per line. Used both to make the typos and
+            as the correctly spelled words to check them against. By default,
+            100000 random words are used.
+  --jobs    Number of processes for checking against the word list (default 1).
+  --seed    Random seed (default 0).
+"""
+
+LETTERS = 'abcdefghijklmnopqrstuvwxyz'
+
+
+def make_random_words(n: int, rng: random.Random) -> List[str]:
+  """Makes random lowercase words with roughly English letter frequencies."""
+  weights = [8.2, 1.5, 2.8, 4.3, 12.7, 2.2, 2.0, 6.1, 7.0, 0.2, 0.8, 4.0, 2.4,
+             6.7, 7.5, 1.9, 0.1, 6.0, 6.3, 9.1, 2.8, 1.0, 2.4, 0.2, 2.0, 0.1]
+  return [''.join(rng.choices(LETTERS, weights, k=rng.randint(3, 14)))
+          for _ in range(n)]
+
+
+def misspell(word: str, rng: random.Random) -> str:
+  """Applies a random typing error to `word`."""
+  i = rng.randrange(len(word) - 1)
+  edit = rng.randrange(4)
+  if edit == 0:  # Transpose two letters.
+    return word[:i] + word[i + 1] + word[i] + word[i + 2:]
+  elif edit == 1:  # Drop a letter.
+    return word[:i] + word[i + 1:]
+  elif edit == 2:  # Double a letter.
+    return word[:i] + word[i] + word[i:]
+  else:  # Hit a wrong letter.
+    return word[:i] + rng.choice(LETTERS) + word[i + 1:]
+
+
+def make_dictionary(size: int, words: List[str],
+                    rng: random.Random) -> List[Tuple[str, str]]:
+  """Makes `size` valid entries, no typo being a substring of another."""
+  candidates = set()
+  long_words = [w for w in words if len(w) >= 6]
+  while len(candidates) < 2 * size:
+    word = rng.choice(long_words)
+    typo = misspell(word, rng)
+    if typo == word:
+      continue
+    elif rng.random() < 0.1:
+      typo = ':' + typo
+    candidates.add((typo, word))
+
+  # Keep typos shortest first, skipping any that contain a kept typo.
+  kept: Set[str] = set()
+  entries = []
+  for typo, word in sorted(candidates, key=lambda e: (len(e[0]), e)):
+    if typo in kept or any(typo[i:j] in kept for i in range(len(typo))
+                           for j in range(i + 5, len(typo) + 1)):
+      continue
+    kept.add(typo)
+    entries.append((typo, word))
+  rng.shuffle(entries)
+  return entries[:size]
+
+
+def time_call(fun, *args):
+  """Calls fun(*args) with output suppressed, returning (result, seconds)."""
+  start = time.perf_counter()
+  with contextlib.redirect_stdout(io.StringIO()):
+    result = fun(*args)
+  return result, time.perf_counter() - start
+
+
+def main(argv):
+  sizes = [1000, 3000, 10000, 30000, 100000]
+  words_file = None
+  jobs = 1
+  seed = 0
+
+  for arg in argv[1:]:
+    if arg.startswith('--'):  # Parse command line options.
+      option, value = arg.split('=', 1)
+      if option == '--sizes':
+        sizes = [int(v) for v in value.split(',')]
+      elif option == '--words':
+        words_file = value
+      elif option == '--jobs':
+        jobs = int(value)
+      elif option == '--seed':
+        seed = int(value)
+      else:
+        print(f'Invalid option: {arg}')
+        sys.exit(1)
+    else:
+      print(HELP_TEXT)
+      sys.exit(1)
+
+  rng = random.Random(seed)
+  if words_file:
+    words = sorted({line.strip().lower() for line in open(words_file, 'rt')
+                    if line.strip().isalpha() and line.strip().isascii()})
+  else:
+    words = make_random_words(100000, rng)
+  generator.CORRECT_WORDS = set(words)
+  print(f'{len(words)} words, {jobs} job(s).\n')
+  print('   Entries  validate (s)  trie (s)  serialize (s)     bytes')
+
+  with tempfile.TemporaryDirectory() as temp_dir:
+    for size in sizes:
+      entries = make_dictionary(size, words, rng)
+      dict_file = os.path.join(temp_dir, f'dict{size}.txt')
+      with open(dict_file, 'wt') as f:
+        f.write(''.join(f'{typo} -> {word}\n'
+                        for typo, word in entries))
+
+      autocorrections, validate_time = time_call(
+          generator.parse_file, dict_file, jobs)
+      trie, trie_time = time_call(generator.make_trie, autocorrections)
+      start = time.perf_counter()
+      try:
+        data, _ = time_call(generator.serialize_trie, autocorrections, trie)
+        size = f'{len(data):8d}'
+      except SystemExit:  # The table exceeds 64KB.
+        size = 'over 64KB'
+      serialized = f'{time.perf_counter() - start:13.2f}  {size:>8}'
+      print(f'{len(autocorrections):10d}  {validate_time:12.2f}  '
+            f'{trie_time:8.2f}  {serialized}')
+
+
+if __name__ == '__main__':
+  main(sys.argv)
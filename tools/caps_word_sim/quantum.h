@@ -0,0 +1,133 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file quantum.h
+ * @brief Minimal stand-in for QMK's quantum.h to build caps_word.c natively.
+ *
+ * This defines only what features/caps_word.c and keycode_classes.c use, with
+ * the same names and values as in QMK. The mods and keyboard report are
+ * modeled in report_count.c.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+
+// Key events and records.
+typedef struct {
+  uint8_t col;
+  uint8_t row;
+} keypos_t;
+
+typedef struct {
+  keypos_t key;
+  uint16_t time;
+  bool pressed;
+} keyevent_t;
+
+typedef struct {
+  bool interrupted : 1;
+  bool reserved2 : 1;
+  bool reserved1 : 1;
+  bool reserved0 : 1;
+  uint8_t count : 4;
+} tap_t;
+
+typedef struct {
+  keyevent_t event;
+  tap_t tap;
+} keyrecord_t;
+
+// Keycodes.
+enum {
+  KC_NO = 0,
+  KC_A = 0x04,
+  KC_Z = 0x1D,
+  KC_1 = 0x1E,
+  KC_0 = 0x27,
+  KC_ENT = 0x28,
+  KC_BSPC = 0x2A,
+  KC_SPC = 0x2C,
+  KC_MINS = 0x2D,
+  KC_SLSH = 0x38,
+  KC_DEL = 0x4C,
+  KC_LCTL = 0xE0,
+  KC_LSFT = 0xE1,
+  KC_RSFT = 0xE5,
+  KC_RALT = 0xE6,
+  KC_RGUI = 0xE7,
+};
+
+#define QK_LSFT 0x0200
+#define QK_RSFT 0x1200
+#define QK_RALT 0x1400
+#define QK_MODS_GET_MODS(kc) (((kc) >> 8) & 0x1F)
+#define QK_MODS_GET_BASIC_KEYCODE(kc) ((kc) & 0xFF)
+#define S(kc) ((kc) | QK_LSFT)
+#define RSFT(kc) ((kc) | QK_RSFT)
+#define KC_UNDS S(KC_MINS)
+
+#define QK_MOD_TAP 0x2000
+#define QK_MOD_TAP_MAX 0x3FFF
+#define QK_MOD_TAP_GET_MODS(kc) (((kc) >> 8) & 0x1F)
+#define QK_MOD_TAP_GET_TAP_KEYCODE(kc) ((kc) & 0xFF)
+#define IS_QK_MOD_TAP(kc) (QK_MOD_TAP <= (kc) && (kc) <= QK_MOD_TAP_MAX)
+#define QK_LAYER_TAP 0x4000
+#define QK_LAYER_TAP_MAX 0x4FFF
+#define QK_LAYER_TAP_GET_TAP_KEYCODE(kc) ((kc) & 0xFF)
+#define QK_LAYER_MOD 0x5000
+#define QK_LAYER_MOD_MAX 0x51FF
+#define QK_TO 0x5200
+#define QK_TO_MAX 0x521F
+#define QK_MOMENTARY 0x5220
+#define QK_MOMENTARY_MAX 0x523F
+#define QK_DEF_LAYER 0x5240
+#define QK_DEF_LAYER_MAX 0x525F
+#define QK_TOGGLE_LAYER 0x5260
+#define QK_TOGGLE_LAYER_MAX 0x527F
+#define QK_ONE_SHOT_LAYER 0x5280
+#define QK_ONE_SHOT_LAYER_MAX 0x529F
+#define QK_ONE_SHOT_MOD 0x52A0
+#define QK_ONE_SHOT_MOD_MAX 0x52BF
+#define QK_LAYER_TAP_TOGGLE 0x52C0
+#define QK_LAYER_TAP_TOGGLE_MAX 0x52DF
+#define OSM(mod) (QK_ONE_SHOT_MOD | ((mod) & 0x1F))
+
+// Mods.
+enum {
+  MOD_LCTL = 0x01,
+  MOD_LSFT = 0x02,
+  MOD_RSFT = 0x12,
+  MOD_RALT = 0x14,
+};
+#define MOD_BIT(kc) (1 << ((kc) & 7))
+#define MOD_MASK_SHIFT (MOD_BIT(KC_LSFT) | MOD_BIT(KC_RSFT))
+
+uint8_t get_mods(void);
+void add_mods(uint8_t mods);
+void del_mods(uint8_t mods);
+void clear_mods(void);
+uint8_t get_weak_mods(void);
+void add_weak_mods(uint8_t mods);
+void set_weak_mods(uint8_t mods);
+void clear_weak_mods(void);
+void unregister_weak_mods(uint8_t mods);
+uint8_t get_oneshot_mods(void);
+void clear_oneshot_mods(void);
+void send_keyboard_report(void);
@@ -0,0 +1,245 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * @file report_count.c
+ * @brief Counts the HID reports sent while typing identifiers with Caps Word.
+ *
+ * This program runs features/caps_word.c natively, fed by a model of how QMK
+ * registers keys and sends keyboard reports, and counts the reports sent to
+ * type each identifier. Use it like
+ *
+ *     make && ./report_count MAX_SIZE F2_KEY
+ *
+ * or without arguments for a built-in list of identifiers. For each, Caps Word
+ * is turned on, the identifier is typed in lowercase with digits and '_', and
+ * a space ends it. With --rollover, each key is pressed before the previous
+ * one is released, as in fast typing.
+ *
+ * As in QMK, a report is sent only if it differs from the last one sent, a
+ * basic key sends a report on press and release, and a shifted keycode like
+ * KC_UNDS applies weak shift with a report of its own before the key. The
+ * host's view is decoded from the reports and checked to be the identifier in
+ * uppercase. To compare with another version of caps_word.c, build with
+ *
+ *     make -B CAPS_WORD=path/to/caps_word.c
+ *
+ * The output is a line "<identifier> reports=N" for each identifier, then a
+ * single line of "name=value" fields.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "caps_word.h"
+
+typedef struct {
+  uint8_t mods;
+  uint8_t keys[6];
+} report_t;
+
+static uint8_t mods = 0;
+static uint8_t weak_mods = 0;
+static uint8_t keys[6] = {0};
+static report_t last_report = {0};
+static uint32_t num_reports = 0;
+// The text that the host sees.
+static char text[256];
+static size_t text_size = 0;
+
+uint8_t get_mods(void) { return mods; }
+void add_mods(uint8_t m) { mods |= m; }
+void del_mods(uint8_t m) { mods &= ~m; }
+void clear_mods(void) { mods = 0; }
+uint8_t get_weak_mods(void) { return weak_mods; }
+void add_weak_mods(uint8_t m) { weak_mods |= m; }
+void set_weak_mods(uint8_t m) { weak_mods = m; }
+void clear_weak_mods(void) { weak_mods = 0; }
+uint8_t get_oneshot_mods(void) { return 0; }
+void clear_oneshot_mods(void) {}
+
+// Types the character of `key` on a US layout, as the host would on seeing it
+// pressed.
+static void host_type(uint8_t key, bool shifted) {
+  static const char unshifted_chars[] = "1234567890\n\x1b\b\t -";
+  static const char shifted_chars[] = "!@#$%^&*()\n\x1b\b\t _";
+  char c = '?';
+  if (KC_A <= key && key <= KC_Z) {
+    c = (shifted ? 'A' : 'a') + (key - KC_A);
+  } else if (KC_1 <= key && key <= KC_MINS) {
+    c = (shifted ? shifted_chars : unshifted_chars)[key - KC_1];
+  }
+  if (text_size + 1 < sizeof(text)) {
+    text[text_size++] = c;
+  }
+}
+
+void send_keyboard_report(void) {
+  report_t report = {mods | weak_mods, {0}};
+  memcpy(report.keys, keys, sizeof(keys));
+  // Like QMK's send_6kro_report(), send only if the report changed.
+  if (!memcmp(&report, &last_report, sizeof(report))) {
+    return;
+  }
+  for (int i = 0; i < 6; ++i) {
+    if (report.keys[i] && !memchr(last_report.keys, report.keys[i], 6)) {
+      host_type(report.keys[i], report.mods & MOD_MASK_SHIFT);
+    }
+  }
+  last_report = report;
+  ++num_reports;
+}
+
+void unregister_weak_mods(uint8_t m) {
+  weak_mods &= ~m;
+  send_keyboard_report();
+}
+
+// Converts the 5-bit mods of a keycode like S(kc) to 8-bit mods.
+static uint8_t mod_bits(uint16_t keycode) {
+  const uint8_t m = QK_MODS_GET_MODS(keycode);
+  return (m & 0x10) ? (m & 0x0F) << 4 : m;
+}
+
+// Presses or releases `keycode`, as QMK's process_action() does for a basic
+// keycode, possibly with mods, after process_caps_word().
+static void key_event(uint16_t keycode, bool pressed) {
+  keyrecord_t record = {0};
+  record.event.pressed = pressed;
+  if (!process_caps_word(keycode, &record)) {
+    return;
+  }
+
+  const uint8_t key = QK_MODS_GET_BASIC_KEYCODE(keycode);
+  const uint8_t m = mod_bits(keycode);
+  uint8_t* slot = memchr(keys, pressed ? 0 : key, sizeof(keys));
+  if (pressed) {
+    if (m) {
+      add_weak_mods(m);
+      send_keyboard_report();
+    }
+    if (slot) {
+      *slot = key;
+    }
+    send_keyboard_report();
+  } else {
+    if (slot) {
+      *slot = 0;
+    }
+    send_keyboard_report();
+    if (m) {
+      weak_mods &= ~m;
+      send_keyboard_report();
+    }
+  }
+}
+
+static uint16_t char_to_keycode(char c) {
+  if ('A' <= c && c <= 'Z') {
+    return KC_A + (c - 'A');  // Typed lowercase, shifted by Caps Word.
+  } else if ('1' <= c && c <= '9') {
+    return KC_1 + (c - '1');
+  }
+  switch (c) {
+    case '0':
+      return KC_0;
+    case '_':
+      return KC_UNDS;
+    case ' ':
+      return KC_SPC;
+  }
+  return KC_NO;
+}
+
+// Types `identifier` and a space with Caps Word, returning the reports sent.
+static uint32_t type_identifier(const char* identifier, bool rollover) {
+  const uint32_t start = num_reports;
+  text_size = 0;
+  caps_word_on();
+  uint16_t held = KC_NO;
+  for (const char* p = identifier;; ++p) {
+    const uint16_t keycode = char_to_keycode(*p ? *p : ' ');
+    // A repeated key can't roll over, so it is released first.
+    const bool roll = rollover && keycode != held;
+    if (!roll && held) {
+      key_event(held, false);
+    }
+    key_event(keycode, true);
+    if (roll && held) {
+      key_event(held, false);
+    }
+    held = keycode;
+    if (!*p) {
+      break;
+    }
+  }
+  key_event(held, false);
+
+  text[text_size] = '\0';
+  if (strncmp(text, identifier, strlen(identifier)) ||
+      text_size != strlen(identifier) + 1) {
+    printf("Error: Typed \"%s\" as \"%s\".\n", identifier, text);
+    exit(1);
+  }
+  return num_reports - start;
+}
+
+int main(int argc, char** argv) {
+  static const char* default_identifiers[] = {
+      "MAX_SIZE",      "KC_A", "F2_KEY", "SHA256", "X11_DISPLAY", "UTF8",
+      "DEBUG_LEVEL_2", "HTTP_404_NOT_FOUND",
+  };
+  const char** identifiers = default_identifiers;
+  int num_identifiers =
+      sizeof(default_identifiers) / sizeof(default_identifiers[0]);
+  bool rollover = false;
+
+  int num_args = 0;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--rollover")) {
+      rollover = true;
+    } else if (argv[i][0] == '-') {
+      fprintf(stderr, "Use: report_count [--rollover] [IDENTIFIER ...]\n");
+      return 1;
+    } else {
+      argv[1 + num_args++] = argv[i];
+    }
+  }
+  if (num_args) {
+    identifiers = (const char**)argv + 1;
+    num_identifiers = num_args;
+  }
+
+  uint32_t keys_typed = 0;
+  for (int i = 0; i < num_identifiers; ++i) {
+    for (const char* p = identifiers[i]; *p; ++p) {
+      if (char_to_keycode(*p) == KC_NO || *p == ' ') {
+        fprintf(stderr, "Unsupported character '%c' in %s\n", *p,
+                identifiers[i]);
+        return 1;
+      }
+    }
+    printf("%s reports=%u\n", identifiers[i],
+           type_identifier(identifiers[i], rollover));
+    keys_typed += strlen(identifiers[i]) + 1;
+  }
+
+  printf("identifiers=%d keys=%u reports=%u per_identifier=%.2f "
+         "per_key=%.3f\n",
+         num_identifiers, keys_typed, num_reports,
+         (double)num_reports / num_identifiers,
+         (double)num_reports / keys_typed);
+  return 0;
+}
@@ -14,7 +14,9 @@
 
 """Program to count character frequencies."""
 import collections
+import math
 import sys
+import textwrap
 from typing import Dict, List, Set
 
 HELP_TEXT = """Count character frequencies.
@@ -29,8 +31,24 @@ Options:
             --chars=letters          Only letters A-Z,a-z
             --chars=symbols+digits   Symbols and digits (default)
             --chars=all              All characters
+  --bigrams Show the N most frequent letter bigrams, e.g. --bigrams=30
+  --streak_table
+            Write a C header of Achordion streak timeouts per letter bigram,
+            e.g. --streak_table=achordion_streak_data.h. Frequent bigrams get
+            tight timeouts and rare bigrams loose ones. Bigrams that never
+            occur in the input disable the streak, so that they may be used as
+            hotkeys. See features/achordion.h, ACHORDION_STREAK_BIGRAMS.
+  --streak_min
+            Streak timeout in ms for the most frequent bigrams (default 60).
+  --streak_max
+            Streak timeout in ms for the rarest bigrams (default 240).
 """
 
+LETTERS = 'abcdefghijklmnopqrstuvwxyz'
+# Number of timeout levels in the streak table. Each bigram's level is stored
+# in 4 bits, where level 0 disables the streak.
+STREAK_LEVELS = 15
+
 
 def count_chars(input_file_names: List[str]) -> Dict[str, int]:
   """Counts how often each char occurs in `input_file_names`."""
@@ -43,6 +61,19 @@ def count_chars(input_file_names: List[str]) -> Dict[str, int]:
   return dict(hist)
 
 
+def count_bigrams(input_file_names: List[str]) -> Dict[str, int]:
+  """Counts how often each pair of consecutive letters a-z occurs."""
+  hist = collections.defaultdict(int)
+  for file_name in input_file_names:
+    for line in open(file_name, 'rt'):
+      line = line.lower()
+      for i in range(len(line) - 1):
+        if line[i] in LETTERS and line[i + 1] in LETTERS:
+          hist[line[i:i + 2]] += 1
+
+  return dict(hist)
+
+
 def print_char_count_table(hist: Dict[str, int], chars: str) -> None:
   """Prints results table of char counts, filtered according to `chars`."""
   if chars == 'all':
@@ -62,6 +93,80 @@ def print_char_count_table(hist: Dict[str, int], chars: str) -> None:
   print(f'\ntotal chars: {total_chars}\n')
 
 
+def print_bigram_count_table(hist: Dict[str, int], num_bigrams: int) -> None:
+  """Prints results table of the `num_bigrams` most frequent bigrams."""
+  ranked_bigrams = sorted(hist, key=lambda bigram: (-hist[bigram], bigram))
+  total_bigrams = sum(hist.values())
+  print('Rank  bigram    count        %')
+  for i, bigram in enumerate(ranked_bigrams[:num_bigrams]):
+    percent = (100.0 / total_bigrams) * hist[bigram]
+    print(f'#{(i + 1):<3} {repr(bigram):>7} {hist[bigram]:8} {percent:8.3f}')
+
+  print(f'\ntotal bigrams: {total_bigrams}\n')
+
+
+def make_streak_levels(hist: Dict[str, int]) -> List[int]:
+  """Maps each bigram to a timeout level in 1-STREAK_LEVELS, or 0 if unseen.
+
+  Levels are spaced uniformly in log frequency, with level 1 for the most
+  frequent bigram and level STREAK_LEVELS for the rarest. Bigrams are ordered
+  as a*26 + b for letters a, b in 0-25.
+  """
+  counts = [hist.get(a + b, 0) for a in LETTERS for b in LETTERS]
+  seen = [math.log(count) for count in counts if count]
+  if not seen:
+    print('Error: No letter bigrams found in the input.')
+    sys.exit(1)
+
+  log_max = max(seen)
+  log_range = max(log_max - min(seen), 1e-9)
+  return [1 + round((STREAK_LEVELS - 1) * (log_max - math.log(count))
+                    / log_range) if count else 0 for count in counts]
+
+
+def write_streak_table(hist: Dict[str, int], input_file_names: List[str],
+                       min_ms: int, max_ms: int, file_name: str) -> None:
+  """Writes the bigram streak timeouts as generated C code to `file_name`."""
+  if not (0 < min_ms <= max_ms):
+    print(f'Error: Invalid streak timeout range {min_ms}-{max_ms} ms.')
+    sys.exit(1)
+
+  levels = make_streak_levels(hist)
+  step = round((max_ms - min_ms) / (STREAK_LEVELS - 1))
+  # Pack two levels per byte, low nibble first.
+  data = [levels[i] | (levels[i + 1] << 4) for i in range(0, len(levels), 2)]
+
+  ranked_bigrams = sorted(hist, key=lambda bigram: (-hist[bigram], bigram))
+  grid = ''.join(
+      f'//   {a}  ' + ''.join('%x' % levels[26 * i + j] for j in range(26))
+      + '\n' for i, a in enumerate(LETTERS))
+
+  generated_code = ''.join([
+    '// Generated code.\n\n',
+    f'// Achordion streak timeouts for letter bigrams, from '
+    f'{sum(hist.values())} bigrams in:\n',
+    ''.join(f'//   {name}\n' for name in input_file_names),
+    '// Most frequent: ' + ' '.join(ranked_bigrams[:16]) + '\n',
+    '//\n',
+    '// Timeout levels by first letter (row) and second letter (column). '
+    'Level n\n',
+    '// means MIN + (n - 1) * STEP ms, and level 0 disables the streak.\n',
+    '//      ' + LETTERS + '\n',
+    grid,
+    f'\n#define ACHORDION_STREAK_BIGRAM_MIN {min_ms}\n',
+    f'#define ACHORDION_STREAK_BIGRAM_STEP {step}\n\n',
+    textwrap.fill(
+        'static const uint8_t achordion_streak_bigram_data[%d] PROGMEM = {%s};'
+        % (len(data), ', '.join(map(str, data))),
+        width=80, subsequent_indent='  '),
+    '\n\n'])
+
+  with open(file_name, 'wt') as f:
+    f.write(generated_code)
+
+  print(f'Wrote streak table of {len(data)} bytes to {file_name}.')
+
+
 def parse_chars_option(value: str) -> Set[str]:
   """Parses the `--chars` command line option."""
   char_sets = {
@@ -83,6 +188,10 @@ def parse_chars_option(value: str) -> Set[str]:
 
 def main(argv):
   chars = 'symbols+digits'  # Show counts for symbols and digits by default.
+  num_bigrams = 0
+  streak_table = None
+  streak_min = 60
+  streak_max = 240
   input_file_names = []
 
   for arg in argv[1:]:
@@ -90,6 +199,14 @@ def main(argv):
       option, value = arg.split('=', 1)
       if option == '--chars':
         chars = value
+      elif option == '--bigrams':
+        num_bigrams = int(value)
+      elif option == '--streak_table':
+        streak_table = value
+      elif option == '--streak_min':
+        streak_min = int(value)
+      elif option == '--streak_max':
+        streak_max = int(value)
       else:
         print(f'Invalid option: {arg}')
         sys.exit(1)
@@ -104,6 +221,14 @@ def main(argv):
   hist = count_chars(input_file_names)
   print_char_count_table(hist, chars)
 
+  if num_bigrams or streak_table:
+    bigram_hist = count_bigrams(input_file_names)
+    if num_bigrams:
+      print_bigram_count_table(bigram_hist, num_bigrams)
+    if streak_table:
+      write_streak_table(bigram_hist, input_file_names, streak_min, streak_max,
+                         streak_table)
+
 
 if __name__ == '__main__':
   main(sys.argv)
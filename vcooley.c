@@ -90,6 +90,21 @@ enum custom_keycodes {
 ///////////////////////////////////////////////////////////////////////////////
 // Tap-hold configuration (https://docs.qmk.fm/tap_hold)
 ///////////////////////////////////////////////////////////////////////////////
+#if defined(ACHORDION_ENABLE) && defined(ACHORDION_DATA)
+// The tap-hold configuration is defined in achordion_policy.py and read from
+// the tables generated from it in achordion_data.h.
+uint16_t get_tapping_term(uint16_t keycode, keyrecord_t* record) {
+  return achordion_data_tapping_term(record->event.key);
+}
+
+uint16_t get_quick_tap_term(uint16_t keycode, keyrecord_t* record) {
+  return achordion_data_quick_tap_term(record->event.key);
+}
+
+bool get_retro_tapping(uint16_t keycode, keyrecord_t *record) {
+  return achordion_data_retro_tapping(record->event.key);
+}
+#else
 uint16_t get_tapping_term(uint16_t keycode, keyrecord_t* record) {
   switch (keycode) {
     case MT(MOD_LCTL, KC_ESC):
@@ -129,6 +144,7 @@ bool get_retro_tapping(uint16_t keycode, keyrecord_t *record) {
       return false;
   }
 }
+#endif  // defined(ACHORDION_ENABLE) && defined(ACHORDION_DATA)
 
 ///////////////////////////////////////////////////////////////////////////////
 // Achordion (https://getreuer.info/posts/keyboards/achordion)
@@ -149,7 +165,9 @@ bool achordion_chord(uint16_t tap_hold_keycode,
       return true;
   }
 
-  return achordion_opposite_hands(tap_hold_record, other_record);
+  // Otherwise the opposite hands rule, or the classifier if enabled.
+  return achordion_default_chord(tap_hold_keycode, tap_hold_record,
+                                 other_keycode, other_record);
 }
 
 uint16_t achordion_timeout(uint16_t tap_hold_keycode) {
@@ -173,11 +191,19 @@ uint16_t achordion_streak_chord_timeout(
 
   // Otherwise, tap_hold_keycode is a mod-tap key.
   const uint8_t mod = mod_config(QK_MOD_TAP_GET_MODS(tap_hold_keycode));
+#ifdef ACHORDION_STREAK_BIGRAMS
+  // Use the corpus-derived timeout for the letter pair, but keep it short for
+  // Shift mod-tap keys.
+  const uint16_t timeout =
+      achordion_streak_bigram_timeout(tap_hold_keycode, next_keycode);
+  return ((mod & MOD_LSFT) != 0 && timeout > 100) ? 100 : timeout;
+#else
   if ((mod & MOD_LSFT) != 0) {
     return 100;  // A short streak timeout for Shift mod-tap keys.
   } else {
     return 220;  // A longer timeout otherwise.
   }
+#endif  // ACHORDION_STREAK_BIGRAMS
 }
 #endif  // ACHORDION_ENABLE
 